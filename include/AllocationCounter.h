@@ -0,0 +1,17 @@
+#pragma once
+
+#include "_Common.h"
+
+// It counts the calls of the global operator new when the project is configured with TRACK_ALLOCATIONS=ON.
+// Otherwise, all counters stay zero and the default operators are used. The totals cover all threads, but a frame
+// counts only the allocations of the thread which began it.
+class AllocationCounter
+{
+public:
+   [[nodiscard]] static bool isEnabled();
+   [[nodiscard]] static uint64_t getAllocationNum();
+   [[nodiscard]] static uint64_t getAllocatedBytes();
+   static void beginFrame();
+   [[nodiscard]] static uint64_t getFrameAllocationNum();
+   [[nodiscard]] static uint64_t getFrameAllocatedBytes();
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "_Common.h"
+
+// It owns the custom buffers of an object and hands out handles, which are indices into a flat table and carry the
+// element type, so an update is an array access checked at the compile time.
+class BufferRegistry
+{
+public:
+   template<typename T>
+   class Handle
+   {
+   public:
+      Handle() : Index( -1 ) {}
+
+      [[nodiscard]] bool isValid() const { return Index >= 0; }
+
+   private:
+      friend class BufferRegistry;
+
+      int Index;
+
+      explicit Handle(int index) : Index( index ) {}
+   };
+
+   struct BufferInfo
+   {
+      std::string Name; // only for the reports
+      GLuint Buffer;
+      GLenum Target;
+      GLsizeiptr Size;
+      GLsizeiptr ElementSize;
+      GLbitfield StorageFlags;
+      GLint BindingIndex; // -1 if the buffer is not bound to an indexed target
+
+      BufferInfo() :
+         Buffer( 0 ), Target( GL_NONE ), Size( 0 ), ElementSize( 0 ), StorageFlags( 0 ), BindingIndex( -1 ) {}
+   };
+
+   BufferRegistry(const BufferRegistry&) = delete;
+   BufferRegistry(const BufferRegistry&&) = delete;
+   BufferRegistry& operator=(const BufferRegistry&) = delete;
+   BufferRegistry& operator=(const BufferRegistry&&) = delete;
+
+
+   BufferRegistry() = default;
+   ~BufferRegistry();
+
+   // The storage is immutable, so the flags have to include GL_DYNAMIC_STORAGE_BIT for the later updates.
+   template<typename T>
+   Handle<T> add(
+      const std::string& name,
+      GLenum target,
+      GLsizeiptr element_num,
+      const T* data,
+      GLbitfield storage_flags,
+      GLint binding_index = -1
+   )
+   {
+      return Handle<T>( add( name, target, static_cast<GLsizeiptr>(sizeof( T )), element_num, data, storage_flags, binding_index ) );
+   }
+
+   // It writes the elements from the first element on, and the rest of the buffer keeps its contents.
+   template<typename T>
+   void update(Handle<T> handle, const std::vector<T>& data, GLsizeiptr first_element = 0)
+   {
+      update( handle.Index, first_element, static_cast<GLsizeiptr>(data.size()), data.data() );
+   }
+
+   // It tells the driver the old contents are not needed anymore, so the next update does not wait for the draws
+   // still reading them.
+   template<typename T>
+   void orphan(Handle<T> handle)
+   {
+      orphan( handle.Index );
+   }
+
+   template<typename T>
+   void bind(Handle<T> handle) const
+   {
+      bind( handle.Index );
+   }
+
+   template<typename T>
+   [[nodiscard]] const BufferInfo& getInfo(Handle<T> handle) const { return Buffers[handle.Index]; }
+
+   [[nodiscard]] GLsizeiptr getMemorySize() const;
+   [[nodiscard]] int getBufferNum() const { return static_cast<int>(Buffers.size()); }
+   [[nodiscard]] const std::vector<BufferInfo>& getBuffers() const { return Buffers; }
+
+private:
+   std::vector<BufferInfo> Buffers;
+
+   int add(
+      const std::string& name,
+      GLenum target,
+      GLsizeiptr element_size,
+      GLsizeiptr element_num,
+      const void* data,
+      GLbitfield storage_flags,
+      GLint binding_index
+   );
+   void update(int index, GLsizeiptr first_element, GLsizeiptr element_num, const void* data);
+   void orphan(int index);
+   void bind(int index) const;
+};
\ No newline at end of file
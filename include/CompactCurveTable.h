@@ -0,0 +1,35 @@
+#pragma once
+
+#include "_Common.h"
+
+// It stores the 2D samples of a curve as 16-bit fixed-point values relative to the bounding box of the curve.
+// The z-coordinates are dropped because all curves lie on the xy-plane.
+class CompactCurveTable
+{
+public:
+   CompactCurveTable();
+
+   void encode(const std::vector<glm::vec3>& samples);
+   void clear();
+   [[nodiscard]] bool empty() const { return Samples.empty(); }
+   [[nodiscard]] int size() const { return static_cast<int>(Samples.size()); }
+   [[nodiscard]] glm::vec3 getSample(int index) const
+   {
+      const glm::u16vec2& sample = Samples[index];
+      return { Offset.x + Step.x * static_cast<float>(sample.x), Offset.y + Step.y * static_cast<float>(sample.y), 0.0f };
+   }
+   [[nodiscard]] const std::vector<glm::u16vec2>& getData() const { return Samples; }
+   [[nodiscard]] glm::vec3 getOffset() const { return { Offset, 0.0f }; }
+   // The normalized integer attributes in [0, 1] are mapped to the bounding box by offset + extent * value.
+   [[nodiscard]] glm::vec3 getExtent() const { return { Step * static_cast<float>(MaxValue), 1.0f }; }
+   [[nodiscard]] float getErrorBound() const { return ErrorBound; }
+   [[nodiscard]] size_t getMemorySize() const { return sizeof( glm::u16vec2 ) * Samples.size(); }
+
+private:
+   inline static constexpr uint MaxValue = 0xFFFFu;
+
+   glm::vec2 Offset;
+   glm::vec2 Step;
+   float ErrorBound; // the maximum distance between a decoded sample and its original one
+   std::vector<glm::u16vec2> Samples;
+};
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "VertexLayout.h"
+
+// It draws any number of line strips from one vertex buffer with one glDrawElements. The strips are separated by
+// the fixed primitive restart index, and each vertex carries the index of its curve, which selects the color of
+// the curve from a shader storage buffer, so recoloring a curve does not touch the vertices.
+class CurveBatch
+{
+public:
+   enum LayoutLocation { VertexLoc = 0, CurveIndexLoc = 3 };
+
+   using Layout = VertexLayout<VertexAttribute<VertexLoc, glm::vec3>, VertexAttribute<CurveIndexLoc, GLuint>>;
+
+   CurveBatch(const CurveBatch&) = delete;
+   CurveBatch(const CurveBatch&&) = delete;
+   CurveBatch& operator=(const CurveBatch&) = delete;
+   CurveBatch& operator=(const CurveBatch&&) = delete;
+
+
+   explicit CurveBatch(GLuint color_binding_index = 0);
+   ~CurveBatch();
+
+   void clear();
+   // It returns the index of the curve, which is also the index of its color in the shader storage buffer.
+   int addCurve(const std::vector<glm::vec3>& vertices, const glm::vec4& color);
+   void setColor(int curve_index, const glm::vec4& color);
+   // Only the curves appended since the last upload are transferred, unless a buffer had to grow.
+   void upload();
+   // The vertex array and the color buffer of the batch have to be bound, and the primitive restart enabled.
+   void draw() const;
+   [[nodiscard]] GLuint getVAO() const { return VAO; }
+   [[nodiscard]] GLuint getColorBuffer() const { return ColorBuffer; }
+   [[nodiscard]] GLuint getColorBindingIndex() const { return ColorBindingIndex; }
+   [[nodiscard]] int getCurveNum() const { return static_cast<int>(Colors.size()); }
+   [[nodiscard]] size_t getVertexNum() const { return Vertices.size(); }
+   [[nodiscard]] GLsizei getIndexNum() const { return static_cast<GLsizei>(Indices.size()); }
+   [[nodiscard]] GLsizeiptr getGPUMemorySize() const
+   {
+      return VertexBufferCapacity + IndexBufferCapacity + ColorBufferCapacity;
+   }
+
+private:
+   inline static constexpr GLuint RestartIndex = 0xFFFFFFFF;
+
+   const GLuint ColorBindingIndex;
+   GLuint VAO;
+   GLuint VBO;
+   GLuint IBO;
+   GLuint ColorBuffer;
+   GLsizeiptr VertexBufferCapacity;
+   GLsizeiptr IndexBufferCapacity;
+   GLsizeiptr ColorBufferCapacity;
+   size_t UploadedVertexNum;
+   size_t UploadedIndexNum;
+   bool ColorsChanged;
+   std::vector<Layout::Vertex> Vertices;
+   std::vector<GLuint> Indices;
+   std::vector<glm::vec4> Colors;
+
+   // It returns true if the buffer was replaced by a larger one, whose contents have to be uploaded again.
+   static bool reserveBuffer(GLuint& buffer, GLsizeiptr& capacity, GLsizeiptr size);
+};
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "_Common.h"
+#include "CompactCurveTable.h"
+#include <list>
+
+class CurveCache
+{
+public:
+   struct Key
+   {
+      std::vector<glm::vec3> ControlPoints;
+      std::vector<int> SampleNums;
+
+      Key(
+         const std::vector<glm::vec3>& position_control_points,
+         const std::vector<glm::vec3>& velocity_control_points,
+         std::vector<int> sample_nums
+      );
+      bool operator==(const Key& other) const
+      {
+         return ControlPoints == other.ControlPoints && SampleNums == other.SampleNums;
+      }
+   };
+
+   // Either the float tables or the compact ones are filled, so the compact tables are cached without the originals.
+   struct Tables
+   {
+      std::vector<glm::vec3> Curve;  // the samples to draw the curve
+      std::vector<glm::vec3> Motion; // the positions of the moving point at each frame
+      CompactCurveTable CompactCurve;
+      CompactCurveTable CompactMotion;
+   };
+
+   explicit CurveCache(size_t memory_budget = 64 * 1024 * 1024);
+
+   // It returns nullptr if there is no entry, and the returned tables are valid until the next insertion.
+   [[nodiscard]] const Tables* find(const Key& key);
+   void insert(Key key, Tables tables);
+   void clear();
+   void setMemoryBudget(size_t memory_budget);
+   [[nodiscard]] size_t getMemoryBudget() const { return MemoryBudget; }
+   [[nodiscard]] size_t getMemoryUsage() const { return MemoryUsage; }
+   [[nodiscard]] size_t getEntryNum() const { return Entries.size(); }
+   [[nodiscard]] uint64_t getHitNum() const { return HitNum; }
+   [[nodiscard]] uint64_t getMissNum() const { return MissNum; }
+   [[nodiscard]] uint64_t getEvictionNum() const { return EvictionNum; }
+
+private:
+   struct Entry
+   {
+      Key CacheKey;
+      Tables CachedTables;
+      size_t Bytes;
+   };
+
+   struct KeyHasher
+   {
+      size_t operator()(const Key& key) const;
+   };
+
+   size_t MemoryBudget;
+   size_t MemoryUsage;
+   uint64_t HitNum;
+   uint64_t MissNum;
+   uint64_t EvictionNum;
+   std::list<Entry> Entries; // the most recently used entry is at the front.
+   std::unordered_map<Key, std::list<Entry>::iterator, KeyHasher> Indices;
+
+   [[nodiscard]] static size_t getBytes(const Key& key, const Tables& tables);
+   void evict();
+};
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "_Common.h"
+#include <atomic>
+
+// It passes the input events from the event thread to the render thread. There is exactly one producer and one
+// consumer, so each index is written by one side only and pushing or popping never takes a lock. The consumer
+// sleeps on a condition variable only when the queue is empty, and the producer notifies it only in that case.
+class EventQueue
+{
+public:
+   enum class TYPE { KEY = 0, MOUSE_BUTTON, FRAMEBUFFER_SIZE, REFRESH };
+
+   struct Event
+   {
+      TYPE Type;
+      int Key; // the key or the mouse button
+      int Scancode;
+      int Action;
+      int Mods;
+      int Width;
+      int Height;
+      double CursorX; // the cursor position when the event thread received the event
+      double CursorY;
+      std::chrono::steady_clock::time_point Time;
+
+      Event() :
+         Type( TYPE::REFRESH ), Key( 0 ), Scancode( 0 ), Action( 0 ), Mods( 0 ), Width( 0 ), Height( 0 ),
+         CursorX( 0.0 ), CursorY( 0.0 ) {}
+   };
+
+   EventQueue(const EventQueue&) = delete;
+   EventQueue(const EventQueue&&) = delete;
+   EventQueue& operator=(const EventQueue&) = delete;
+   EventQueue& operator=(const EventQueue&&) = delete;
+
+
+   // The capacity is rounded up to a power of two.
+   explicit EventQueue(size_t capacity = 1024);
+   ~EventQueue() = default;
+
+   // Only the producer pushes, and it returns false if the queue is full.
+   bool push(const Event& event);
+   // Only the consumer pops and waits.
+   bool pop(Event& event);
+   void wait(double timeout_seconds);
+   // Any thread can wake up the consumer, e.g. when something other than an event needs a redraw.
+   void wake();
+   [[nodiscard]] bool empty() const;
+   [[nodiscard]] size_t getCapacity() const { return Slots.size(); }
+   [[nodiscard]] uint64_t getFullNum() const { return FullNum.load( std::memory_order_relaxed ); }
+
+private:
+   const size_t Mask;
+   std::vector<Event> Slots;
+   alignas(64) std::atomic<size_t> Head; // the next slot to pop, which only the consumer writes
+   size_t CachedTail;                    // the last tail the consumer read
+   alignas(64) std::atomic<size_t> Tail; // the next slot to push, which only the producer writes
+   size_t CachedHead;                    // the last head the producer read
+   std::atomic<uint64_t> FullNum;
+   alignas(64) std::atomic<bool> Sleeping;
+   bool WakeRequested;
+   std::mutex WakeLock;
+   std::condition_variable Woken;
+
+   [[nodiscard]] static size_t getPowerOfTwo(size_t capacity);
+};
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "_Common.h"
+#include <atomic>
+#include <deque>
+
+// It reads each frame into one of the pixel buffer objects in a ring and maps it a few frames later when its fence
+// has signaled, so glReadPixels never stalls the pipeline. A writer thread streams the frames to the disk.
+class FrameCapturer
+{
+public:
+   enum class FORMAT { RAW_RGBA = 0, Y4M };
+
+   FrameCapturer(const FrameCapturer&) = delete;
+   FrameCapturer(const FrameCapturer&&) = delete;
+   FrameCapturer& operator=(const FrameCapturer&) = delete;
+   FrameCapturer& operator=(const FrameCapturer&&) = delete;
+
+
+   explicit FrameCapturer(int buffer_num = 3, int max_queued_frame_num = 8);
+   ~FrameCapturer();
+
+   // The y4m format is chosen when the file has the .y4m extension.
+   [[nodiscard]] bool start(const std::string& file_path, int width, int height, int frame_rate = 60);
+   // It reads the currently bound read framebuffer, so it should be called after rendering a frame.
+   void capture();
+   void finish();
+   [[nodiscard]] bool isCapturing() const { return Writer.joinable(); }
+   // The writer thread counts the frames while capturing, so the number can be behind the captured frames.
+   [[nodiscard]] uint64_t getCapturedFrameNum() const { return CapturedFrameNum.load( std::memory_order_relaxed ); }
+
+private:
+   struct PixelBuffer
+   {
+      GLuint Buffer;
+      GLsync Fence;
+
+      PixelBuffer() : Buffer( 0 ), Fence( nullptr ) {}
+   };
+
+   const int BufferNum;
+   const int MaxQueuedFrameNum;
+   int Width;
+   int Height;
+   int FrameRate;
+   int NextBufferIndex;
+   int AllocatedFrameNum;
+   FORMAT Format;
+   bool StopRequested;
+   std::atomic<uint64_t> CapturedFrameNum; // only the writer thread increments it
+   std::vector<PixelBuffer> PixelBuffers;
+   std::ofstream File;
+   std::deque<std::vector<uchar>> QueuedFrames;
+   std::vector<std::vector<uchar>> FreeFrames;
+   std::vector<uchar> ConvertedFrame;
+   std::chrono::steady_clock::time_point StartTime;
+   std::thread Writer;
+   std::mutex Lock;
+   std::condition_variable FrameQueued;
+   std::condition_variable FrameWritten;
+
+   [[nodiscard]] size_t getFrameSize() const { return static_cast<size_t>(Width) * Height * 4; }
+   void readBack(PixelBuffer& pixel_buffer);
+   void writeFrames();
+   void writeRawFrame(const std::vector<uchar>& frame);
+   void writeY4MFrame(const std::vector<uchar>& frame);
+};
\ No newline at end of file
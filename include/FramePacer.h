@@ -0,0 +1,77 @@
+#pragma once
+
+#include "_Common.h"
+
+// It bounds how many frames the CPU can submit ahead of the GPU. Every frame ends with a timestamp query and a fence,
+// and a new frame waits for the fence of the oldest frame only when the maximum number of frames is in flight.
+// The timestamp of a frame which reflects an input is mapped to the steady clock, so the latency from the callback
+// of the input to the GPU completion of the frame is estimated without stalling the pipeline.
+class FramePacer
+{
+public:
+   struct Statistics
+   {
+      double AverageMilliseconds, P99Milliseconds, MaxMilliseconds;
+      int SampleNum;
+
+      Statistics() : AverageMilliseconds( 0.0 ), P99Milliseconds( 0.0 ), MaxMilliseconds( 0.0 ), SampleNum( 0 ) {}
+   };
+
+   FramePacer(const FramePacer&) = delete;
+   FramePacer(const FramePacer&&) = delete;
+   FramePacer& operator=(const FramePacer&) = delete;
+   FramePacer& operator=(const FramePacer&&) = delete;
+
+
+   explicit FramePacer(int max_frames_in_flight = 2, int window_size = 256);
+   ~FramePacer();
+
+   // It needs the current OpenGL context.
+   void start();
+   // It blocks until the oldest frame finishes if the maximum number of frames is in flight.
+   void beginFrame();
+   // It has to follow the swap of the frame, and the input time is when the first input reflected in it arrived.
+   // A default input time is never a real input, so such a frame does not give a latency sample.
+   void endFrame(bool reflects_input, const std::chrono::steady_clock::time_point& input_time);
+   // It waits for all frames in flight and releases the fences and the queries.
+   void finish();
+   [[nodiscard]] int getMaxFramesInFlight() const { return MaxFramesInFlight; }
+   [[nodiscard]] uint64_t getFrameNum() const { return FrameNum; }
+   [[nodiscard]] uint64_t getBlockedFrameNum() const { return BlockedFrameNum; }
+   [[nodiscard]] double getBlockedMilliseconds() const { return BlockedMilliseconds; }
+   [[nodiscard]] uint64_t getRejectedSampleNum() const { return RejectedSampleNum; }
+   [[nodiscard]] Statistics getLatencyStatistics();
+   void print();
+
+private:
+   struct Frame
+   {
+      GLsync Fence;
+      GLuint Query;
+      bool ReflectsInput;
+      std::chrono::steady_clock::time_point InputTime;
+
+      Frame() : Fence( nullptr ), Query( 0 ), ReflectsInput( false ) {}
+   };
+
+   inline static constexpr uint64_t CalibrationInterval = 600;
+
+   const int MaxFramesInFlight;
+   const int WindowSize;
+   int OldestFrameIndex;
+   int FrameInFlightNum;
+   int NextSampleIndex;
+   int SampleNum;
+   uint64_t FrameNum;
+   uint64_t BlockedFrameNum;
+   double BlockedMilliseconds;
+   uint64_t RejectedSampleNum; // the latencies which came out negative, e.g. right after the clocks drifted
+   int64_t GPUClockOffset; // the GPU timestamp minus the steady clock in nanoseconds
+   std::vector<Frame> Frames;
+   std::vector<double> LatencySamples; // the rolling window of the latencies in milliseconds
+   std::vector<double> SortedSamples;
+
+   void calibrate();
+   // It returns false if the oldest frame has not finished yet and blocking is not allowed.
+   bool retireOldestFrame(bool block);
+};
\ No newline at end of file
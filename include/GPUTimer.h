@@ -0,0 +1,71 @@
+#pragma once
+
+#include "_Common.h"
+
+// It measures the GPU time of each render pass with timestamp queries. Every pass owns a ring of query pairs,
+// and a result is read only when the ring comes back to it and the result is available, so reading never stalls.
+class GPUTimer
+{
+public:
+   struct Statistics
+   {
+      double MinMilliseconds, AverageMilliseconds, P99Milliseconds;
+      int SampleNum;
+
+      Statistics() : MinMilliseconds( 0.0 ), AverageMilliseconds( 0.0 ), P99Milliseconds( 0.0 ), SampleNum( 0 ) {}
+   };
+
+   class Scope
+   {
+   public:
+      Scope(GPUTimer& timer, int pass_index) : Timer( timer ), PassIndex( pass_index ) { Timer.begin( PassIndex ); }
+      ~Scope() { Timer.end( PassIndex ); }
+
+   private:
+      GPUTimer& Timer;
+      const int PassIndex;
+   };
+
+   GPUTimer(const GPUTimer&) = delete;
+   GPUTimer(const GPUTimer&&) = delete;
+   GPUTimer& operator=(const GPUTimer&) = delete;
+   GPUTimer& operator=(const GPUTimer&&) = delete;
+
+
+   explicit GPUTimer(int query_ring_size = 4, int window_size = 256);
+   ~GPUTimer();
+
+   // It needs the current OpenGL context and returns the index of the pass.
+   int addPass(const std::string& name);
+   // It collects the available results of the queries which are about to be reused.
+   void beginFrame();
+   void begin(int pass_index);
+   void end(int pass_index);
+   [[nodiscard]] uint64_t getFrameNum() const { return FrameNum; }
+   [[nodiscard]] uint64_t getDroppedSampleNum() const { return DroppedSampleNum; }
+   [[nodiscard]] int getPassNum() const { return static_cast<int>(Passes.size()); }
+   [[nodiscard]] const std::string& getPassName(int pass_index) const { return Passes[pass_index].Name; }
+   [[nodiscard]] Statistics getStatistics(int pass_index);
+   void print();
+   void destroyQueries();
+
+private:
+   struct Pass
+   {
+      std::string Name;
+      std::vector<GLuint> BeginQueries;
+      std::vector<GLuint> EndQueries;
+      std::vector<bool> Pending;
+      std::vector<double> Samples; // the rolling window of the elapsed times in milliseconds
+      int NextSampleIndex;
+      int SampleNum;
+   };
+
+   const int QueryRingSize;
+   const int WindowSize;
+   int RingIndex;
+   uint64_t FrameNum;
+   uint64_t DroppedSampleNum;
+   std::vector<Pass> Passes;
+   std::vector<double> SortedSamples;
+};
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "_Common.h"
+#include "EventQueue.h"
+
+// It records the keys and the mouse buttons with the cursor position into a compact binary log, and replays them
+// at the recorded or at the maximum speed. The maximum speed feeds the next event as soon as the renderer is idle,
+// so a replay runs the same curve creation and playback without the pauses of the user in between.
+class InputRecorder
+{
+public:
+   enum class REPLAY_SPEED { RECORDED = 0, MAXIMUM };
+
+   InputRecorder(const InputRecorder&) = delete;
+   InputRecorder(const InputRecorder&&) = delete;
+   InputRecorder& operator=(const InputRecorder&) = delete;
+   InputRecorder& operator=(const InputRecorder&&) = delete;
+
+
+   InputRecorder();
+   ~InputRecorder();
+
+   bool startRecording(const std::string& file_path, int width, int height);
+   // It is called on the event thread, and only the keys and the mouse buttons are recorded.
+   void record(const EventQueue::Event& event);
+   void finishRecording();
+   bool startReplaying(const std::string& file_path, REPLAY_SPEED speed, int width, int height);
+   // It returns the next event if it is due, which is only when the renderer is idle at the maximum speed.
+   bool getDueEvent(EventQueue::Event& event, bool idle);
+   void finishReplaying();
+   [[nodiscard]] bool isRecording() const { return RecordFile.is_open(); }
+   [[nodiscard]] bool isReplaying() const { return Replaying; }
+   [[nodiscard]] bool hasReplayFinished() const { return NextRecordIndex == Records.size(); }
+   [[nodiscard]] double getSecondsToNextEvent() const;
+
+private:
+   struct FileHeader
+   {
+      char Magic[4];
+      uint32_t Version;
+      uint32_t Width;  // the size of the window, in which the cursor positions are
+      uint32_t Height;
+   };
+
+   struct Record
+   {
+      uint32_t DeltaMicroseconds; // from the previous event, or from the start for the first event
+      uint8_t Type;
+      uint8_t Action;
+      uint8_t Mods;
+      uint8_t Reserved;
+      int32_t Key;                // the key or the mouse button
+      int32_t Scancode;
+      float CursorX;
+      float CursorY;
+   };
+
+   inline static constexpr uint32_t Version = 1;
+   std::ofstream RecordFile;
+   std::chrono::steady_clock::time_point LastRecordTime;
+   uint64_t RecordedEventNum;
+   bool Replaying;
+   REPLAY_SPEED ReplaySpeed;
+   std::vector<Record> Records;
+   std::vector<uint64_t> RecordTimes; // the microseconds from the start of the replay
+   size_t NextRecordIndex;
+   std::chrono::steady_clock::time_point ReplayStartTime;
+
+   [[nodiscard]] uint64_t getReplayMicroseconds() const;
+};
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "_Common.h"
+
+class LazySampleProvider
+{
+public:
+   using Generator = std::function<glm::vec3(int)>;
+
+   LazySampleProvider(const LazySampleProvider&) = delete;
+   LazySampleProvider(const LazySampleProvider&&) = delete;
+   LazySampleProvider& operator=(const LazySampleProvider&) = delete;
+   LazySampleProvider& operator=(const LazySampleProvider&&) = delete;
+
+
+   explicit LazySampleProvider(int chunk_size = 64, int window_chunk_num = 8);
+   ~LazySampleProvider();
+
+   void start(int sample_num, Generator generator);
+   void stop();
+   [[nodiscard]] bool isRunning() const { return Worker.joinable(); }
+   [[nodiscard]] int getSampleNum() const { return SampleNum; }
+   [[nodiscard]] glm::vec3 getSample(int index);
+
+private:
+   const int ChunkSize;
+   const int WindowChunkNum;
+   int SampleNum;
+   int ChunkNum;
+
+   // The chunks in [CursorChunk, NextChunk) are ready in the ring buffer, and the worker only computes
+   // NextChunk while it is less than CursorChunk + WindowChunkNum, so it never writes a slot being read.
+   int CursorChunk;
+   int NextChunk;
+   int Generation;
+   bool StopRequested;
+   Generator SampleGenerator;
+   std::vector<glm::vec3> Window;
+   std::thread Worker;
+   std::mutex Lock;
+   std::condition_variable CursorMoved;
+   std::condition_variable ChunkReady;
+
+   void generate();
+};
\ No newline at end of file
@@ -1,11 +1,30 @@
 #pragma once
 
 #include "Shader.h"
+#include "TextureLoader.h"
+#include "TextureCache.h"
+#include "BufferRegistry.h"
+#include "VertexLayout.h"
+#include "Profiler.h"
 
 class ObjectGL
 {
 public:
    enum LayoutLocation { VertexLoc = 0, NormalLoc, TextureLoc };
+   enum SegmentLocation { SegmentStartLoc = 0, SegmentEndLoc };
+   // The packed formats keep only x and y, which are mapped to VertexOffset + VertexScale * vertex in the shader.
+   enum class VERTEX_FORMAT { FLOAT_XYZ = 0, HALF_XY, UNORM16_XY };
+
+   using PositionLayout = VertexLayout<VertexAttribute<VertexLoc, glm::vec3>>;
+   using PositionNormalLayout = VertexLayout<VertexAttribute<VertexLoc, glm::vec3>, VertexAttribute<NormalLoc, glm::vec3>>;
+   using PositionTextureLayout = VertexLayout<VertexAttribute<VertexLoc, glm::vec3>, VertexAttribute<TextureLoc, glm::vec2>>;
+   using PositionNormalTextureLayout = VertexLayout<
+      VertexAttribute<VertexLoc, glm::vec3>,
+      VertexAttribute<NormalLoc, glm::vec3>,
+      VertexAttribute<TextureLoc, glm::vec2>
+   >;
+   using NormalizedPositionLayout = VertexLayout<VertexAttribute<VertexLoc, glm::u16vec2>>;
+   using HalfPositionLayout = VertexLayout<VertexAttribute<VertexLoc, HalfVector2>>;
 
    ObjectGL();
    ~ObjectGL();
@@ -15,6 +34,9 @@ public:
    void setDiffuseReflectionColor(const glm::vec4& diffuse_reflection_color);
    void setSpecularReflectionColor(const glm::vec4& specular_reflection_color);
    void setSpecularReflectionExponent(const float& specular_reflection_exponent);
+   // The format applies to the positions given without the other attributes, and it should be set before setObject
+   // to size the vertex buffer.
+   void setVertexFormat(VERTEX_FORMAT format) { VertexFormat = format; }
    void setObject(GLenum draw_mode, int vertex_num);
    void setObject(GLenum draw_mode, const std::vector<glm::vec3>& vertices);
    void setObject(
@@ -51,66 +73,135 @@ public:
    );
    int addTexture(const std::string& texture_file_path, bool is_grayscale = false);
    void addTexture(int width, int height, bool is_grayscale = false);
+   // The storage of a texture is immutable, so a new size takes a new texture, which keeps the index of the old one.
+   void replaceTexture(int index, int width, int height, bool is_grayscale = false);
    int addTexture(const uint8_t* image_buffer, int width, int height, bool is_grayscale = false);
+   // The image and its mipmap levels are mapped from the cache file, which is built at the first load.
+   int addTexture(TextureCache& cache, const std::string& texture_file_path, bool is_grayscale = false);
+   // The texture is added at once, but its image is decoded and uploaded later by the loader.
+   TextureLoader::Handle addTexture(TextureLoader& loader, const std::string& texture_file_path, bool is_grayscale = false);
    void transferUniformsToShader(const ShaderGL* shader);
    void updateDataBuffer(const std::vector<glm::vec3>& vertices);
    void updateDataBuffer(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals);
+   // The normalized vertices in [0, 1] are mapped to offset + scale * vertex in the vertex shader.
+   void updateDataBuffer(
+      const std::vector<glm::u16vec2>& normalized_vertices,
+      const glm::vec3& offset,
+      const glm::vec3& scale
+   );
    void updateDataBuffer(
       const std::vector<glm::vec3>& vertices,
       const std::vector<glm::vec3>& normals,
       const std::vector<glm::vec2>& textures
    );
-   void replaceVertices(const std::vector<glm::vec3>& vertices, bool normals_exist, bool textures_exist);
-   void replaceVertices(const std::vector<float>& vertices, bool normals_exist, bool textures_exist);
+   // Only the positions, which are the first attribute of the layout, are overwritten.
+   void replaceVertices(const std::vector<glm::vec3>& vertices);
+   void replaceVertices(const std::vector<float>& vertices);
    [[nodiscard]] GLuint getVAO() const { return VAO; }
+   // The segments of the lines are drawn as instances, which read their two end points from the vertex buffer of
+   // the object at the offsets of consecutive vertices. The vertex array is created at the first call.
+   [[nodiscard]] GLuint getSegmentVAO();
+   [[nodiscard]] GLsizei getSegmentNum() const;
    [[nodiscard]] GLenum getDrawMode() const { return DrawMode; }
+   [[nodiscard]] VERTEX_FORMAT getVertexFormat() const { return VertexFormat; }
    [[nodiscard]] GLsizei getVertexNum() const { return VerticesCount; }
    [[nodiscard]] GLuint getTextureID(int index) const { return TextureID[index]; }
    [[nodiscard]] int getTextureNum() const { return static_cast<int>(TextureID.size()); }
 
+   // The attributes are interleaved as the layout describes, and the layout sets the vertex format of the VAO.
+   template<typename Layout, typename... Types>
+   void setObject(GLenum draw_mode, const std::vector<Types>&... attributes)
+   {
+      DrawMode = draw_mode;
+      VerticesCount = static_cast<GLsizei>(std::min( { attributes.size()... } ));
+      prepareVertexBuffer( Layout::Stride, Layout::pack( PackedVertices, attributes... ) );
+      useLayout<Layout>();
+   }
+
+   template<typename Layout, typename... Types>
+   void updateDataBuffer(const std::vector<Types>&... attributes)
+   {
+      updateDataBuffer<Layout>( Layout::pack( PackedVertices, attributes... ), std::min( { attributes.size()... } ) );
+   }
+
+   // The vertices are already laid out as the layout describes, so they are uploaded as they are.
+   template<typename Layout>
+   void updateDataBuffer(const void* vertices, size_t vertex_num)
+   {
+      PROFILE_ZONE( "ObjectGL::updateDataBuffer" );
+
+      assert( VBO != 0 );
+
+      VerticesCount = static_cast<GLsizei>(vertex_num);
+      const auto size = static_cast<GLsizeiptr>(Layout::Stride) * VerticesCount;
+      reserveVertexBuffer( size );
+      useLayout<Layout>();
+      glNamedBufferSubData( VBO, 0, size, vertices );
+   }
+
    template<typename T>
-   void addShaderStorageBufferObject(const std::string& name, GLuint binding_index, int data_size)
+   BufferRegistry::Handle<T> addShaderStorageBufferObject(const std::string& name, GLuint binding_index, int data_size)
    {
-      GLuint buffer;
-      glCreateBuffers( 1, &buffer );
-      glBindBufferBase( GL_SHADER_STORAGE_BUFFER, binding_index, buffer );
-      glBufferStorage( GL_SHADER_STORAGE_BUFFER, sizeof( T ) * data_size, nullptr, GL_DYNAMIC_DRAW );
-      CustomBuffers[name] = buffer;
+      return CustomBuffers.add<T>(
+         name, GL_SHADER_STORAGE_BUFFER, data_size, nullptr, GL_DYNAMIC_STORAGE_BIT, static_cast<GLint>(binding_index)
+      );
    }
 
    template<typename T>
-   void addCustomBufferObject(
+   BufferRegistry::Handle<T> addCustomBufferObject(
       const std::string& name,
       GLenum target,
       const std::vector<T>& data,
-      GLenum usage
+      GLbitfield storage_flags = GL_DYNAMIC_STORAGE_BIT
    )
    {
-      GLuint buffer;
-      glCreateBuffers( 1, &buffer );
-      glBindBuffer( target, buffer );
-      glBufferStorage( target, sizeof( T ) * data.size(), data.data(), usage );
-      CustomBuffers[name] = buffer;
+      return CustomBuffers.add<T>(
+         name, target, static_cast<GLsizeiptr>(data.size()), data.data(), storage_flags
+      );
    }
 
+   // The data are written from the first element on, so a part of the buffer can be updated.
    template<typename T>
-   void updateCustomBufferObject(const std::string& name, const std::vector<T>& data)
+   void updateCustomBufferObject(
+      BufferRegistry::Handle<T> handle,
+      const std::vector<T>& data,
+      GLsizeiptr first_element = 0
+   )
    {
-      const auto it = CustomBuffers.find( name );
-      if (it == CustomBuffers.end()) return;
+      CustomBuffers.update( handle, data, first_element );
+   }
 
-      glNamedBufferSubData( it->second, 0, sizeof( T ) * data.size(), data.data() );
+   // The whole buffer is rewritten, so the old contents can be orphaned instead of waiting for the GPU.
+   template<typename T>
+   void replaceCustomBufferObject(BufferRegistry::Handle<T> handle, const std::vector<T>& data)
+   {
+      CustomBuffers.orphan( handle );
+      CustomBuffers.update( handle, data );
    }
 
+   [[nodiscard]] const BufferRegistry& getCustomBuffers() const { return CustomBuffers; }
+   // It adds up the vertex buffer, the custom buffers and all mipmap levels of the textures.
+   [[nodiscard]] GLsizeiptr getGPUMemorySize() const;
+
 private:
-   uint8_t* ImageBuffer;
-   std::vector<GLfloat> DataBuffer;
+   std::vector<uint8_t> PackedVertices; // the interleaved vertices of the layouts with more than one attribute
+   std::vector<HalfVector2> HalfPositions;
+   std::vector<glm::u16vec2> NormalizedPositions;
    GLuint VAO;
    GLuint VBO;
    GLenum DrawMode;
    std::vector<GLuint> TextureID;
-   std::map<std::string, GLuint> CustomBuffers;
+   BufferRegistry CustomBuffers;
    GLsizei VerticesCount;
+   GLsizei VertexStride;
+   GLsizeiptr VertexBufferSize;
+   VERTEX_FORMAT VertexFormat;
+   const void* CurrentLayout;
+   uint32_t EnabledAttributes;
+   GLuint SegmentVAO;
+   void (*SetSegmentFormat)(GLuint vao, GLuint location, GLuint binding_index); // the position format of the layout
+   glm::vec3 VertexOffset;
+   glm::vec3 VertexScale;
    glm::vec4 EmissionColor;
    glm::vec4 AmbientReflectionColor; // It is usually set to the same color with DiffuseReflectionColor.
                                      // Otherwise, it should be in balance with DiffuseReflectionColor.
@@ -119,9 +210,40 @@ private:
    float SpecularReflectionExponent;
 
    [[nodiscard]] bool prepareTexture2DUsingFreeImage(const std::string& file_path, bool is_grayscale) const;
-   void prepareTexture(bool normals_exist) const;
-   void prepareVertexBuffer(int n_bytes_per_vertex);
-   void prepareNormal() const;
+   void prepareVertexBuffer(GLsizei stride, const void* data);
+   void reserveVertexBuffer(GLsizeiptr size);
+   void updateSegmentArray() const;
+   void updatePositionBuffer(const glm::vec3* vertices, size_t vertex_num);
+   void updateHalfDataBuffer(const glm::vec3* vertices, size_t vertex_num);
+   void updateNormalizedDataBuffer(const glm::vec3* vertices, size_t vertex_num);
+   void replacePositions(const glm::vec3* vertices, size_t vertex_num);
+   static void getBoundingBox(
+      const glm::vec3* vertices,
+      size_t vertex_num,
+      glm::vec2& min_point,
+      glm::vec2& max_point
+   );
+   template<typename Layout>
+   void useLayout()
+   {
+      if (CurrentLayout == Layout::getID()) return;
+
+      // The attributes which the new layout does not have would read past the vertices, so they are disabled.
+      for (uint32_t location = 0; location < 32; ++location) {
+         const uint32_t bit = 1u << location;
+         if ((EnabledAttributes & bit) != 0 && (Layout::LocationMask & bit) == 0) {
+            glDisableVertexArrayAttrib( VAO, location );
+         }
+      }
+      CurrentLayout = Layout::getID();
+      EnabledAttributes = Layout::LocationMask;
+      VertexStride = Layout::Stride;
+      glVertexArrayVertexBuffer( VAO, 0, VBO, 0, VertexStride );
+      Layout::setFormat( VAO, 0 );
+      SetSegmentFormat = &Layout::template setAttributeFormat<0>;
+      updateSegmentArray();
+   }
+
    static void getSquareObject(
       std::vector<glm::vec3>& vertices,
       std::vector<glm::vec3>& normals,
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "_Common.h"
+#include <atomic>
+
+// It records the scoped zones into a ring per thread. Only the owner thread appends to a ring and publishes the number
+// of written zones with a release store, and only the dump consumes it and publishes the number of read zones, so the
+// dump drains all rings without stopping the threads. A zone is dropped only if its ring fills up between two dumps.
+// The ring of a thread which has exited is freed as soon as it has been drained.
+class Profiler
+{
+public:
+   class Scope
+   {
+   public:
+      explicit Scope(const char* name) : Name( name ), Begin( now() ) {}
+      ~Scope() { record( Name, Begin, now() ); }
+
+   private:
+      const char* Name;
+      const int64_t Begin;
+   };
+
+   [[nodiscard]] static int64_t now()
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+         std::chrono::steady_clock::now().time_since_epoch()
+      ).count();
+   }
+   static void record(const char* name, int64_t begin, int64_t end);
+   // It drains the zones recorded since the last dump into a file in the chrome://tracing JSON format.
+   static bool dump(const std::string& file_path);
+   // Both count the zones since the last dump.
+   [[nodiscard]] static uint64_t getZoneNum();
+   [[nodiscard]] static uint64_t getDroppedZoneNum();
+   // It returns the average cost of an empty zone in nanoseconds.
+   [[nodiscard]] static double measureOverhead(int zone_num);
+
+private:
+   struct Zone
+   {
+      const char* Name;
+      int64_t Begin;
+      int64_t End;
+   };
+
+   struct ThreadBuffer
+   {
+      int ThreadID;
+      std::vector<Zone> Zones;
+      std::atomic<uint64_t> WrittenZoneNum; // only the owner thread writes it
+      std::atomic<uint64_t> ReadZoneNum;    // only the dump writes it
+      std::atomic<uint64_t> DroppedZoneNum;
+      bool Retired;                         // the owner thread has exited, which is set under the registry lock
+
+      explicit ThreadBuffer(int thread_id, size_t capacity) :
+         ThreadID( thread_id ), Zones( capacity ), WrittenZoneNum( 0 ), ReadZoneNum( 0 ), DroppedZoneNum( 0 ),
+         Retired( false ) {}
+   };
+
+   // It lives as long as its thread and retires the buffer of the thread when the thread exits.
+   struct ThreadBufferOwner
+   {
+      ThreadBuffer* Buffer;
+
+      ThreadBufferOwner() : Buffer( nullptr ) {}
+      ~ThreadBufferOwner();
+   };
+
+   inline static constexpr size_t ThreadBufferCapacity = 1u << 18; // a power of two
+   inline static std::mutex RegistryLock;
+   inline static std::vector<std::unique_ptr<ThreadBuffer>> ThreadBuffers;
+   inline static int NextThreadID = 0;
+
+   [[nodiscard]] static ThreadBuffer* getThreadBuffer();
+   // The registry lock has to be held.
+   static void freeRetiredBuffers();
+};
+
+#ifdef ENABLE_PROFILER
+#define PROFILE_ZONE_CONCATENATE_INNER(a, b) a##b
+#define PROFILE_ZONE_CONCATENATE(a, b) PROFILE_ZONE_CONCATENATE_INNER(a, b)
+#define PROFILE_ZONE(name) const Profiler::Scope PROFILE_ZONE_CONCATENATE(profile_zone_, __LINE__)( name )
+#else
+#define PROFILE_ZONE(name)
+#endif
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "_Common.h"
+#include <array>
+
+// It remembers the program, the vertex array, the line width, the point size, the blending, the primitive restart and
+// the shader storage buffer bindings last sent to OpenGL and skips the calls which would not change them. All draws
+// have to go through it, or invalidate() has to be called after a direct call, because it cannot see the state
+// changed behind its back.
+class RenderStateCache
+{
+public:
+   RenderStateCache(const RenderStateCache&) = delete;
+   RenderStateCache(const RenderStateCache&&) = delete;
+   RenderStateCache& operator=(const RenderStateCache&) = delete;
+   RenderStateCache& operator=(const RenderStateCache&&) = delete;
+
+
+   RenderStateCache();
+   ~RenderStateCache() = default;
+
+   void useProgram(GLuint program);
+   void bindVertexArray(GLuint vertex_array);
+   void setLineWidth(float width);
+   void setPointSize(float size);
+   void setBlending(bool enabled);
+   // It enables the restart at the fixed index, i.e. the maximum value of the index type.
+   void setPrimitiveRestart(bool enabled);
+   // Only the first binding points are remembered, and the others are always bound.
+   void bindShaderStorageBuffer(GLuint binding_index, GLuint buffer);
+   // It forgets the current state, so the next call of each kind is always issued.
+   void invalidate();
+   // It closes the counters of the last frame.
+   void beginFrame();
+   [[nodiscard]] uint64_t getFrameIssuedCallNum() const { return LastFrameIssuedCallNum; }
+   [[nodiscard]] uint64_t getFrameElidedCallNum() const { return LastFrameElidedCallNum; }
+   [[nodiscard]] uint64_t getTotalIssuedCallNum() const { return TotalIssuedCallNum + IssuedCallNum; }
+   [[nodiscard]] uint64_t getTotalElidedCallNum() const { return TotalElidedCallNum + ElidedCallNum; }
+   void print() const;
+
+private:
+   GLuint Program;
+   GLuint VertexArray;
+   float LineWidth;
+   float PointSize;
+   bool ProgramKnown;
+   bool VertexArrayKnown;
+   bool Blending;
+   bool BlendingKnown;
+   bool PrimitiveRestart;
+   bool PrimitiveRestartKnown;
+   inline static constexpr GLuint RememberedBindingNum = 8;
+   std::array<GLuint, RememberedBindingNum> ShaderStorageBuffers;
+   std::array<bool, RememberedBindingNum> ShaderStorageBuffersKnown;
+   uint64_t IssuedCallNum;
+   uint64_t ElidedCallNum;
+   uint64_t LastFrameIssuedCallNum;
+   uint64_t LastFrameElidedCallNum;
+   uint64_t TotalIssuedCallNum;
+   uint64_t TotalElidedCallNum;
+
+   // It returns true if the call has to be issued.
+   bool update(bool is_same)
+   {
+      if (is_same) {
+         ElidedCallNum++;
+         return false;
+      }
+      IssuedCallNum++;
+      return true;
+   }
+};
\ No newline at end of file
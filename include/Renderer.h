@@ -2,7 +2,21 @@
 
 #include "_Common.h"
 #include "Object.h"
+#include "LazySampleProvider.h"
+#include "CurveCache.h"
+#include "CompactCurveTable.h"
+#include "AllocationCounter.h"
+#include "FrameCapturer.h"
+#include "GPUTimer.h"
+#include "RenderStateCache.h"
+#include "CurveBatch.h"
+#include "FramePacer.h"
+#include "EventQueue.h"
+#include "InputRecorder.h"
 
+// Every renderer owns its window and context, and the callbacks find the renderer through the user pointer of the
+// window, so several renderers can exist in one process. The windows are created on the main thread, but a renderer
+// can render on any thread once no other thread holds its context.
 class RendererGL
 {
 public:
@@ -12,42 +26,158 @@ public:
    RendererGL& operator=(const RendererGL&&) = delete;
 
 
-   RendererGL();
-   ~RendererGL() = default;
+   struct Options
+   {
+      bool Headless;           // render into an offscreen framebuffer of an invisible window without vsync
+      int ContextCreationAPI;  // GLFW_NATIVE_CONTEXT_API, GLFW_EGL_CONTEXT_API or GLFW_OSMESA_CONTEXT_API
+      std::string CapturePath; // the frames are captured into this raw RGBA or y4m file if it is not empty
+      std::string TracePath;   // the profiled zones are dumped into this file on the t key and on exit, and the later
+                               // dumps, which hold only the zones since the previous one, into numbered files;
+                               // nothing is dumped if it is empty
+      bool MultiViewport;      // render the three panels in one pass with a viewport array
+      bool CachedLayers;       // redraw the static contents of the panels into a texture only when they change
+      ObjectGL::VERTEX_FORMAT CurveVertexFormat; // the vertex format of the position and velocity curves
+      int TrajectoryNum;       // the number of random trajectories drawn with one call in the main panel
+      bool ThickLines;         // expand the line segments into anti-aliased quads instead of using glLineWidth
+      int MaxFramesInFlight;   // the number of frames the CPU can submit before it waits for the GPU
+      int SwapInterval;        // the number of vertical blanks a swap waits for, or negative for the driver default
+      bool RenderThread;       // render on a dedicated thread while the main thread only pumps the events
+      std::string RecordPath;  // the keys and the mouse buttons are recorded into this file if it is not empty
+      std::string ReplayPath;  // the input recorded in this file is replayed if it is not empty
+      InputRecorder::REPLAY_SPEED ReplaySpeed;
+
+      Options() :
+         Headless( false ), ContextCreationAPI( GLFW_NATIVE_CONTEXT_API ), TracePath( "trace.json" ),
+         MultiViewport( false ), CachedLayers( false ), CurveVertexFormat( ObjectGL::VERTEX_FORMAT::FLOAT_XYZ ),
+         TrajectoryNum( 0 ), ThickLines( false ), MaxFramesInFlight( 2 ), SwapInterval( -1 ),
+         RenderThread( false ), ReplaySpeed( InputRecorder::REPLAY_SPEED::RECORDED ) {}
+   };
+
+   explicit RendererGL(const Options& options = Options());
+   ~RendererGL();
 
    void play();
+   // It plays a scripted scene without any input and returns false if a frame allocates after warming up.
+   // The context is made current on the calling thread and released at the end.
+   bool benchmark(int frame_num);
+   // It compares the cold and warm loads through the texture cache with the direct FreeImage load.
+   bool benchmarkTextureLoading(const std::vector<std::string>& file_paths);
 
 private:
    enum class MOVE_TYPE { NONE=0, UNIFORM, VARIABLE };
+   enum PANEL { MAIN_PANEL = 1, POSITION_PANEL = 2, VELOCITY_PANEL = 4, ALL_PANELS = 7 };
+
+   struct RedrawStatistics
+   {
+      uint64_t RedrawNum;
+      uint64_t WaitNum;
+      uint64_t LatencySampleNum;
+      uint64_t QueuedEventNum;
+      double IdleSeconds; // the time blocked in glfwWaitEventsTimeout or in the event queue
+      double TotalLatencyMilliseconds;
+      double TotalSquaredLatencyMilliseconds; // for the standard deviation, which is the jitter of the latency
+      double MaxLatencyMilliseconds; // from an invalidating event to the end of its presented frame
+      double TotalQueueDelayMilliseconds;
+      double MaxQueueDelayMilliseconds; // from the callback on the event thread to the dispatch on the render thread
+
+      RedrawStatistics() :
+         RedrawNum( 0 ), WaitNum( 0 ), LatencySampleNum( 0 ), QueuedEventNum( 0 ), IdleSeconds( 0.0 ),
+         TotalLatencyMilliseconds( 0.0 ), TotalSquaredLatencyMilliseconds( 0.0 ), MaxLatencyMilliseconds( 0.0 ),
+         TotalQueueDelayMilliseconds( 0.0 ), MaxQueueDelayMilliseconds( 0.0 ) {}
+   };
 
-   inline static RendererGL* Renderer = nullptr;
    GLFWwindow* Window;
+   GLFWcursor* CrosshairCursor;
+   Options RendererOptions;
+   GLuint OffscreenFBO;
+   GLuint OffscreenColorBuffer;
+   GLuint OffscreenDepthBuffer;
+   GLuint LayerFBO;
+   int LayerTextureIndex; // -1 until the layer texture is created, which is then kept across the plays
    bool PositionMode;
    bool VelocityMode;
+   bool LazySampling;
+   bool CompactTables;
+   bool AdaptiveTessellation;
+   bool MultiViewport;
+   bool CachedLayers;
+   bool ThickLines;
+   bool LayerDirty;
+   bool NeedsRedraw;
+   bool QueuedInput; // the callbacks push the events into the queue, which the render thread dispatches
    MOVE_TYPE MoveType;
    int FrameWidth;
    int FrameHeight;
+   int LayerWidth;        // the size of the layer texture, which follows the size of the framebuffer
+   int LayerHeight;
    int FrameIndex;
+   int TraceDumpNum;
+   uint64_t LayerRedrawNum;
    int PositionCurveSamplePointNum;
    int TotalPositionCurvePointNum;
    int TotalVelocityCurvePointNum;
+   float TessellationTolerance; // the maximum chord error in pixels of the main viewport
+   double TextureUploadBudget;  // the time in milliseconds which uploading textures can take from a frame
+   glm::vec2 ViewportSize;      // the size of the current viewport, in which the thick lines are expanded
+   glm::dvec2 EventCursorPosition; // the cursor position carried by the event being dispatched, as only the event
+                                   // thread can query it and a replayed event has its recorded position
    std::vector<glm::vec3> PositionControlPoints;
    std::vector<glm::vec3> VelocityControlPoints;
    std::vector<glm::vec3> PositionCurve;
    std::vector<glm::vec3> VelocityCurve;
    std::vector<glm::vec3> UniformVelocityCurve;
    std::vector<glm::vec3> VariableVelocityCurve;
+   std::vector<glm::vec3> MovingPoint;
+   CompactCurveTable CompactPositionCurve;
+   CompactCurveTable CompactVelocityCurve;
+   CompactCurveTable CompactUniformVelocityCurve;
+   CompactCurveTable CompactVariableVelocityCurve;
    std::unique_ptr<CameraGL> MainCamera;
    std::unique_ptr<ShaderGL> ObjectShader;
+   std::unique_ptr<ShaderGL> PanelLineShader;
+   std::unique_ptr<ShaderGL> PanelPointShader;
+   std::unique_ptr<ShaderGL> CurveBatchShader;
+   std::unique_ptr<ShaderGL> ThickLineShader;
    std::unique_ptr<ObjectGL> AxisObject;
    std::unique_ptr<ObjectGL> PositionObject;
    std::unique_ptr<ObjectGL> VelocityObject;
    std::unique_ptr<ObjectGL> PositionCurveObject;
    std::unique_ptr<ObjectGL> VelocityCurveObject;
    std::unique_ptr<ObjectGL> MovingObject;
+   std::unique_ptr<ObjectGL> LayerObject;
+   std::unique_ptr<LazySampleProvider> UniformVelocitySampler;
+   std::unique_ptr<LazySampleProvider> VariableVelocitySampler;
+   std::unique_ptr<CurveCache> CurveTableCache;
+   std::unique_ptr<FrameCapturer> Capturer;
+   std::unique_ptr<GPUTimer> PassTimer;
+   std::unique_ptr<RenderStateCache> StateCache;
+   std::unique_ptr<TextureLoader> AsyncTextureLoader;
+   std::unique_ptr<TextureCache> TexelCache;
+   std::unique_ptr<CurveBatch> Trajectories;
+   std::unique_ptr<FramePacer> Pacer;
+   std::unique_ptr<EventQueue> InputEvents;
+   std::unique_ptr<InputRecorder> Recorder;
+   int MainCurvePass;
+   int PositionCurvePass;
+   int VelocityCurvePass;
+   int PanelPass;
+   int LayerPass;
+   int TrajectoryPass;
+   ShaderGL::UniformHandle PanelLineMask;
+   ShaderGL::UniformHandle PanelPointMask;
+   ShaderGL::UniformHandle ThickLineWidth;
+   ShaderGL::UniformHandle ThickLineViewportSize;
+   std::chrono::steady_clock::time_point InvalidatedTime;
+   RedrawStatistics Redraws;
+   std::thread::id EventThreadID; // the thread which created the window, where only the events can be polled
  
    void registerCallbacks() const;
    void initialize();
+   void createOffscreenTarget();
+   void destroyOffscreenTarget();
+   void createLayerTarget();
+   void resizeLayerTarget(int width, int height);
+   void destroyLayerTarget();
 
    static void printOpenGLInformation();
 
@@ -55,32 +185,81 @@ private:
    float getDeltaLength(float t);
    float getCurveLengthFromZeroTo(float t);
    float getInverseCurveLength(float length);
+   [[nodiscard]] float getChordErrorInPixels(const glm::vec3& p0, const glm::vec3& p, const glm::vec3& p1) const;
+   void subdividePositionCurve(float t0, const glm::vec3& p0, float t1, const glm::vec3& p1, int depth);
+   void tessellatePositionCurve();
    void createPositionCurve();
    glm::vec3 getPointOnVelocityBezierCurve(float t);
    void createVelocityCurve();
+   void printCurveCacheStatistics(const char* curve_name) const;
+   static void compactCurveTable(
+      CompactCurveTable& compact_table,
+      std::vector<glm::vec3>& table,
+      const char* table_name
+   );
+   void compactPositionCurve();
+   void compactVelocityCurve();
+   [[nodiscard]] int getPositionCurveSampleNum() const;
+   [[nodiscard]] int getVelocityCurveSampleNum() const;
+   [[nodiscard]] glm::vec3 getUniformMotionPoint(int index) const;
+   [[nodiscard]] glm::vec3 getVariableMotionPoint(int index) const;
+   [[nodiscard]] bool isUniformMotionReady() const;
+   [[nodiscard]] bool isVariableMotionReady() const;
    void clearCurve();
+   void receiveEvent(EventQueue::Event& event);
+   void dispatchEvent(const EventQueue::Event& event);
+   void dispatchEvents();
+   void replayEvents();
 
-   void error(int error, const char* description) const;
+   [[nodiscard]] static RendererGL* getRenderer(GLFWwindow* window);
+   static void error(int error, const char* description);
    void cleanup(GLFWwindow* window);
    void keyboard(GLFWwindow* window, int key, int scancode, int action, int mods);
    void cursor(GLFWwindow* window, double xpos, double ypos);
    void mouse(GLFWwindow* window, int button, int action, int mods);
-   void reshape(GLFWwindow* window, int width, int height) const;
+   void reshape(GLFWwindow* window, int width, int height);
+   void refresh(GLFWwindow* window);
    static void errorWrapper(int error, const char* description);
    static void cleanupWrapper(GLFWwindow* window);
    static void keyboardWrapper(GLFWwindow* window, int key, int scancode, int action, int mods);
    static void cursorWrapper(GLFWwindow* window, double xpos, double ypos);
    static void mouseWrapper(GLFWwindow* window, int button, int action, int mods);
    static void reshapeWrapper(GLFWwindow* window, int width, int height);
+   static void refreshWrapper(GLFWwindow* window);
 
    void setAxisObject() const;
    void setCurveObjects() const;
-   void drawAxisObject() const;
-   void drawControlPoints(ObjectGL* control_points) const;
-   void drawCurve(ObjectGL* curve) const;
+   void setLayerObject();
+   void setTrajectories();
+   void setObjects();
+   void setBenchmarkCurves();
+   void setViewport(int x, int y, int width, int height);
+   void drawLines(ObjectGL* object, const glm::mat4& to_world, float width);
+   void drawThickLines(ObjectGL* object, const glm::mat4& to_world, float width);
+   void drawAxisObject();
+   void drawControlPoints(ObjectGL* control_points);
+   void drawCurve(ObjectGL* curve);
+   bool updateMovingPoint();
    void drawMovingPoint();
-   void drawMainCurve();
-   void drawPositionCurve() const;
-   void drawVelocityCurve() const;
+   void drawTrajectories();
+   void drawMainCurve(bool with_moving_point);
+   void drawPositionCurve();
+   void drawVelocityCurve();
+   void drawObjectInPanels(ObjectGL* object, GLenum draw_mode, const glm::mat4& to_world, int panel_mask);
+   void drawPanelsInOnePass(bool with_moving_point);
+   void drawPanels(bool with_moving_point);
+   void drawCachedLayer();
    void render();
+   void invalidate();
+   [[nodiscard]] bool isAnimating() const;
+   [[nodiscard]] bool isIdle() const;
+   void waitForInvalidation(double timeout_seconds);
+   void printRedrawStatistics(double elapsed_seconds, double cpu_seconds) const;
+   void printGPUMemoryUsage() const;
+   void dumpTrace();
+   void startFrames();
+   void finishFrame();
+   void finishFrames();
+   void renderFrames();
+   void renderOnRenderThread();
 };
\ No newline at end of file
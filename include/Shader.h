@@ -17,17 +17,52 @@ public:
       SpotlightFeather( 0 ) {}
    };
 
+   struct SamplerLocation
+   {
+      GLint Binding, Location;
+
+      SamplerLocation(GLint binding, GLint location) : Binding( binding ), Location( location ) {}
+   };
+
    struct LocationSet
    {
       GLint World, View, Projection, ModelViewProjection;
       GLint MaterialEmission, MaterialAmbient, MaterialDiffuse, MaterialSpecular, MaterialSpecularExponent;
-      std::map<GLint, GLint> Texture; // <binding point, texture id>
+      GLint VertexOffset, VertexScale;
+      std::vector<SamplerLocation> Texture;
       GLint UseTexture, UseLight, LightNum, GlobalAmbient;
       std::vector<LightLocationSet> Lights;
 
       LocationSet() : World( 0 ), View( 0 ), Projection( 0 ), ModelViewProjection( 0 ), MaterialEmission( 0 ),
       MaterialAmbient( 0 ), MaterialDiffuse( 0 ), MaterialSpecular( 0 ), MaterialSpecularExponent( 0 ),
-      UseTexture( 0 ), UseLight( 0 ), LightNum( 0 ), GlobalAmbient( 0 ) {}
+      VertexOffset( 0 ), VertexScale( 0 ), UseTexture( 0 ), UseLight( 0 ), LightNum( 0 ), GlobalAmbient( 0 ) {}
+   };
+
+   // It indexes the table of the active uniforms reflected at the link. All the programs of the shader share the
+   // table, so every handle is invalidated when setShader or setComputeShaders links and reflects again.
+   class UniformHandle
+   {
+   public:
+      UniformHandle() : Index( -1 ) {}
+      explicit UniformHandle(int index) : Index( index ) {}
+
+      [[nodiscard]] bool isValid() const { return Index >= 0; }
+      [[nodiscard]] int getIndex() const { return Index; }
+
+   private:
+      int Index;
+   };
+
+   struct UniformInfo
+   {
+      std::string Name; // the trailing [0] of an array is removed
+      GLuint Program;
+      GLenum Type;
+      GLint Location;
+      GLint ArraySize;
+
+      UniformInfo(std::string name, GLuint program, GLenum type, GLint location, GLint array_size) :
+         Name( std::move( name ) ), Program( program ), Type( type ), Location( location ), ArraySize( array_size ) {}
    };
 
    ShaderGL();
@@ -38,20 +73,36 @@ public:
       const char* fragment_shader_path,
       const char* geometry_shader_path = nullptr,
       const char* tessellation_control_shader_path = nullptr,
-      const char* tessellation_evaluation_shader_path = nullptr
+      const char* tessellation_evaluation_shader_path = nullptr,
+      const std::vector<std::string>& uniform_names = {}
+   );
+   void setComputeShaders(
+      const std::vector<const char*>& compute_shader_paths,
+      const std::vector<std::vector<std::string>>& uniform_names = {}
    );
-   void setComputeShaders(const std::vector<const char*>& compute_shader_paths);
    void setUniformLocations(int light_num);
-   void addUniformLocation(const std::string& name);
-   void addUniformLocationToComputeShader(const std::string& name, int shader_index);
+   // They report the names which are not active uniforms of the linked program and return an invalid handle then.
+   // The names passed to setShader or setComputeShaders are already checked at the link.
+   UniformHandle addUniformLocation(const std::string& name);
+   UniformHandle addUniformLocationToComputeShader(const std::string& name, int shader_index);
    void transferBasicTransformationUniforms(const glm::mat4& to_world, const CameraGL* camera, bool use_texture = false) const;
    [[nodiscard]] GLuint getShaderProgram() const { return ShaderProgram; }
-   [[nodiscard]] GLint getLocation(const std::string& name) const { return CustomLocations.find( name )->second; }
+   [[nodiscard]] GLint getLocation(UniformHandle handle) const
+   {
+      return handle.isValid() ? Uniforms[handle.getIndex()].Location : -1;
+   }
+   [[nodiscard]] GLenum getUniformType(UniformHandle handle) const
+   {
+      return handle.isValid() ? Uniforms[handle.getIndex()].Type : GL_NONE;
+   }
+   [[nodiscard]] const std::vector<UniformInfo>& getUniforms() const { return Uniforms; }
    [[nodiscard]] GLint getMaterialEmissionLocation() const { return Location.MaterialEmission; }
    [[nodiscard]] GLint getMaterialAmbientLocation() const { return Location.MaterialAmbient; }
    [[nodiscard]] GLint getMaterialDiffuseLocation() const { return Location.MaterialDiffuse; }
    [[nodiscard]] GLint getMaterialSpecularLocation() const { return Location.MaterialSpecular; }
    [[nodiscard]] GLint getMaterialSpecularExponentLocation() const { return Location.MaterialSpecularExponent; }
+   [[nodiscard]] GLint getVertexOffsetLocation() const { return Location.VertexOffset; }
+   [[nodiscard]] GLint getVertexScaleLocation() const { return Location.VertexScale; }
    [[nodiscard]] GLint getLightAvailabilityLocation() const { return Location.UseLight; }
    [[nodiscard]] GLint getLightNumLocation() const { return Location.LightNum; }
    [[nodiscard]] GLint getGlobalAmbientLocation() const { return Location.GlobalAmbient; }
@@ -95,12 +146,18 @@ public:
 protected:
    GLuint ShaderProgram;
    LocationSet Location;
-   std::unordered_map<std::string, GLint> CustomLocations;
+   std::vector<UniformInfo> Uniforms; // sorted by the program and the name
    std::vector<GLuint> ComputeShaderPrograms;
 
    static void readShaderFile(std::string& shader_contents, const char* shader_path);
    [[nodiscard]] static std::string getShaderTypeString(GLenum shader_type);
    [[nodiscard]] static bool checkCompileError(GLenum shader_type, const GLuint& shader);
    [[nodiscard]] static GLuint getCompiledShader(GLenum shader_type, const char* shader_path);
+   [[nodiscard]] static bool checkLinkError(GLuint program);
+   void reflectUniforms(GLuint program);
+   [[nodiscard]] bool checkUniforms(GLuint program, const std::vector<std::string>& names) const;
+   [[nodiscard]] int findUniform(GLuint program, const std::string& name) const;
+   [[nodiscard]] GLint findLocation(const std::string& name) const;
+   void setLightUniforms(int light_num);
    void setBasicTransformationUniforms();
 };
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "_Common.h"
+#include <filesystem>
+
+// It keeps the decoded and converted images with all their mipmap levels in files, which are mapped into the memory
+// and uploaded as they are, so only the first load of an image goes through FreeImage. A file is keyed by the path of
+// the source image and is rebuilt when the modification time or the size of the source has changed.
+class TextureCache
+{
+public:
+   TextureCache(const TextureCache&) = delete;
+   TextureCache(const TextureCache&&) = delete;
+   TextureCache& operator=(const TextureCache&) = delete;
+   TextureCache& operator=(const TextureCache&&) = delete;
+
+
+   explicit TextureCache(std::filesystem::path directory_path = getDefaultDirectoryPath());
+   ~TextureCache() = default;
+
+   // It allocates the storage of the texture with all levels and returns false if the image cannot be read.
+   bool upload(GLuint texture, const std::string& file_path, bool is_grayscale);
+   void remove(const std::string& file_path, bool is_grayscale) const;
+   [[nodiscard]] int getHitNum() const { return HitNum; }
+   [[nodiscard]] int getMissNum() const { return MissNum; }
+   [[nodiscard]] const std::filesystem::path& getDirectoryPath() const { return DirectoryPath; }
+   [[nodiscard]] static std::filesystem::path getDefaultDirectoryPath();
+
+private:
+   struct FileHeader
+   {
+      char Magic[4];
+      uint32_t Version;
+      int64_t SourceModifiedTime;
+      uint64_t SourceSize;
+      uint32_t Width;
+      uint32_t Height;
+      uint32_t LevelNum;
+      uint32_t ChannelNum;
+      uint32_t SourcePathLength; // the source path follows the header
+      uint32_t DataOffset;       // the levels are packed tightly from the largest one
+   };
+
+   class MappedFile
+   {
+   public:
+      MappedFile(const MappedFile&) = delete;
+      MappedFile(const MappedFile&&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&&) = delete;
+
+
+      MappedFile();
+      ~MappedFile();
+
+      bool open(const std::filesystem::path& file_path);
+      void close();
+      [[nodiscard]] const uchar* getData() const { return Data; }
+      [[nodiscard]] size_t getSize() const { return Size; }
+
+   private:
+      const uchar* Data;
+      size_t Size;
+#ifdef _WIN32
+      void* File;
+      void* Mapping;
+#endif
+   };
+
+   inline static constexpr uint32_t Version = 1;
+   const std::filesystem::path DirectoryPath;
+   int HitNum;
+   int MissNum;
+
+   [[nodiscard]] std::filesystem::path getCachePath(const std::string& file_path, bool is_grayscale) const;
+   [[nodiscard]] static size_t getLevelSize(const FileHeader& header, uint32_t level);
+   [[nodiscard]] static bool isValid(
+      const MappedFile& file,
+      const std::string& source_path,
+      int64_t source_modified_time,
+      uint64_t source_size
+   );
+   static void buildLevels(
+      std::vector<uchar>& levels,
+      const FileHeader& header,
+      const uchar* bits,
+      size_t pitch
+   );
+   static void uploadLevels(GLuint texture, const FileHeader& header, const uchar* levels);
+};
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "_Common.h"
+#include <atomic>
+#include <deque>
+
+// It decodes the images on a pool of worker threads and uploads them on the OpenGL thread in finalize(), which
+// copies each image into a slot of a persistently mapped pixel buffer and stops when the time budget runs out.
+// The texture names are created at the request, so they can be attached to objects before the images arrive.
+class TextureLoader
+{
+   struct Request;
+
+public:
+   class Handle
+   {
+   public:
+      Handle() = default;
+
+      [[nodiscard]] bool isValid() const { return LoadRequest != nullptr; }
+      [[nodiscard]] bool isReady() const;
+      [[nodiscard]] bool hasFailed() const;
+      // The texture is incomplete until it is ready, so it is sampled as black until then.
+      [[nodiscard]] GLuint getTexture() const;
+
+   private:
+      friend class TextureLoader;
+
+      std::shared_ptr<Request> LoadRequest;
+
+      explicit Handle(std::shared_ptr<Request> request) : LoadRequest( std::move( request ) ) {}
+   };
+
+   TextureLoader(const TextureLoader&) = delete;
+   TextureLoader(const TextureLoader&&) = delete;
+   TextureLoader& operator=(const TextureLoader&) = delete;
+   TextureLoader& operator=(const TextureLoader&&) = delete;
+
+
+   explicit TextureLoader(int worker_num = 2, int staging_slot_num = 4, GLsizeiptr staging_slot_size = 16 << 20);
+   ~TextureLoader();
+
+   // It needs the current OpenGL context, which owns the returned texture.
+   [[nodiscard]] Handle load(const std::string& file_path, bool is_grayscale = false);
+   // It uploads the decoded images until the budget runs out and returns the number of the finished textures.
+   int finalize(double budget_milliseconds);
+   // It blocks the OpenGL thread until the texture is ready or has failed.
+   void wait(const Handle& handle);
+   // It is called on a worker thread whenever an image is decoded, e.g. to wake up the event loop.
+   void setDecodedCallback(std::function<void()> callback) { DecodedCallback = std::move( callback ); }
+   // The decoded images wait for finalize(), so the caller should not block while there are any.
+   [[nodiscard]] bool hasDecodedImages();
+   [[nodiscard]] int getLoadedNum() const { return LoadedNum; }
+   [[nodiscard]] int getFailedNum() const { return FailedNum.load( std::memory_order_relaxed ); }
+   void destroyStagingBuffer();
+   void print();
+
+   // It returns the image converted to 8-bit grayscale or 32-bit BGRA, which the caller has to unload.
+   [[nodiscard]] static FIBITMAP* decode(const std::string& file_path, bool is_grayscale);
+
+private:
+   enum class STATE { DECODING = 0, DECODED, READY, FAILED };
+
+   struct Request
+   {
+      std::string FilePath;
+      bool IsGrayscale;
+      GLuint Texture;
+      FIBITMAP* Bitmap;
+      std::atomic<STATE> State;
+
+      Request(std::string file_path, bool is_grayscale, GLuint texture) :
+         FilePath( std::move( file_path ) ), IsGrayscale( is_grayscale ), Texture( texture ), Bitmap( nullptr ),
+         State( STATE::DECODING ) {}
+   };
+
+   struct StagingSlot
+   {
+      GLsync Fence;
+
+      StagingSlot() : Fence( nullptr ) {}
+   };
+
+   const int StagingSlotNum;
+   const GLsizeiptr StagingSlotSize;
+   GLuint StagingBuffer;
+   uchar* MappedStagingBuffer;
+   std::vector<StagingSlot> StagingSlots;
+   int NextSlotIndex;
+   int LoadedNum;
+   std::atomic<int> FailedNum;
+   double DecodeMilliseconds;
+   double UploadMilliseconds;
+   std::function<void()> DecodedCallback;
+   std::vector<std::thread> Workers;
+   std::deque<std::shared_ptr<Request>> Jobs;
+   std::deque<std::shared_ptr<Request>> DecodedRequests;
+   std::mutex Lock;
+   std::condition_variable JobAdded;
+   std::condition_variable ImageDecoded;
+   bool StopRequested;
+
+   void createStagingBuffer();
+   [[nodiscard]] int acquireStagingSlot();
+   [[nodiscard]] bool upload(Request& request);
+   void decodeImages();
+};
\ No newline at end of file
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "_Common.h"
+#include <array>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+// The component count and type of an attribute are derived from its C++ type.
+template<typename T>
+struct VertexAttributeFormat;
+
+template<>
+struct VertexAttributeFormat<GLfloat>
+{
+   static constexpr GLint ComponentNum = 1;
+   static constexpr GLenum ComponentType = GL_FLOAT;
+   static constexpr GLboolean Normalized = GL_FALSE;
+};
+
+template<>
+struct VertexAttributeFormat<GLuint>
+{
+   static constexpr GLint ComponentNum = 1;
+   static constexpr GLenum ComponentType = GL_UNSIGNED_INT;
+   static constexpr GLboolean Normalized = GL_FALSE;
+};
+
+template<>
+struct VertexAttributeFormat<glm::vec2>
+{
+   static constexpr GLint ComponentNum = 2;
+   static constexpr GLenum ComponentType = GL_FLOAT;
+   static constexpr GLboolean Normalized = GL_FALSE;
+};
+
+template<>
+struct VertexAttributeFormat<glm::vec3>
+{
+   static constexpr GLint ComponentNum = 3;
+   static constexpr GLenum ComponentType = GL_FLOAT;
+   static constexpr GLboolean Normalized = GL_FALSE;
+};
+
+template<>
+struct VertexAttributeFormat<glm::vec4>
+{
+   static constexpr GLint ComponentNum = 4;
+   static constexpr GLenum ComponentType = GL_FLOAT;
+   static constexpr GLboolean Normalized = GL_FALSE;
+};
+
+template<>
+struct VertexAttributeFormat<glm::u16vec2>
+{
+   static constexpr GLint ComponentNum = 2;
+   static constexpr GLenum ComponentType = GL_UNSIGNED_SHORT;
+   static constexpr GLboolean Normalized = GL_TRUE;
+};
+
+template<>
+struct VertexAttributeFormat<glm::u8vec4>
+{
+   static constexpr GLint ComponentNum = 4;
+   static constexpr GLenum ComponentType = GL_UNSIGNED_BYTE;
+   static constexpr GLboolean Normalized = GL_TRUE;
+};
+
+// The bits of two half-precision floats, which are converted with glm::packHalf1x16.
+struct HalfVector2
+{
+   glm::u16vec2 Bits;
+};
+
+template<>
+struct VertexAttributeFormat<HalfVector2>
+{
+   static constexpr GLint ComponentNum = 2;
+   static constexpr GLenum ComponentType = GL_HALF_FLOAT;
+   static constexpr GLboolean Normalized = GL_FALSE;
+};
+
+template<GLuint AttributeLocation, typename T>
+struct VertexAttribute
+{
+   using Type = T;
+   static constexpr GLuint Location = AttributeLocation;
+};
+
+// The attributes are stored one after another in the declared order, so an array of vertices is the buffer itself.
+template<typename... Types>
+struct PackedVertex;
+
+template<typename T>
+struct PackedVertex<T>
+{
+   T Head;
+
+   PackedVertex() = default;
+   explicit PackedVertex(const T& head) : Head( head ) {}
+
+   template<size_t Index>
+   [[nodiscard]] const auto& get() const
+   {
+      static_assert( Index == 0, "The attribute index is out of the range." );
+      return Head;
+   }
+};
+
+template<typename T, typename... Types>
+struct PackedVertex<T, Types...>
+{
+   T Head;
+   PackedVertex<Types...> Tail;
+
+   PackedVertex() = default;
+   PackedVertex(const T& head, const Types&... tail) : Head( head ), Tail( tail... ) {}
+
+   template<size_t Index>
+   [[nodiscard]] const auto& get() const
+   {
+      if constexpr (Index == 0) return Head;
+      else return Tail.template get<Index - 1>();
+   }
+};
+
+template<typename... Types>
+constexpr std::array<GLuint, sizeof...(Types)> getVertexAttributeOffsets()
+{
+   constexpr std::array<GLuint, sizeof...(Types)> sizes{ static_cast<GLuint>(sizeof( Types ))... };
+   std::array<GLuint, sizeof...(Types)> offsets{};
+   for (size_t i = 1; i < sizes.size(); ++i) offsets[i] = offsets[i - 1] + sizes[i - 1];
+   return offsets;
+}
+
+// It derives the stride, the offsets and the vertex format of the interleaved attributes at the compile time.
+template<typename... Attributes>
+class VertexLayout
+{
+public:
+   using Vertex = PackedVertex<typename Attributes::Type...>;
+
+   static constexpr size_t AttributeNum = sizeof...(Attributes);
+   static constexpr GLsizei Stride = static_cast<GLsizei>((sizeof( typename Attributes::Type ) + ...));
+   static constexpr std::array<GLuint, AttributeNum> Offsets =
+      getVertexAttributeOffsets<typename Attributes::Type...>();
+   static constexpr uint32_t LocationMask = ((1u << Attributes::Location) | ...);
+
+   static_assert( sizeof( Vertex ) == static_cast<size_t>(Stride), "The attributes must be packed without padding." );
+   static_assert( std::is_trivially_copyable_v<Vertex>, "The vertices must be copyable into a buffer as bytes." );
+
+   // It identifies the layout without the RTTI, so an object can tell whether its format has to change.
+   [[nodiscard]] static const void* getID()
+   {
+      static const char id = 0;
+      return &id;
+   }
+
+   static void setFormat(GLuint vao, GLuint binding_index)
+   {
+      setFormat( vao, binding_index, std::index_sequence_for<Attributes...>{} );
+   }
+
+   // It sets the format of an attribute for another location and binding, so the same buffer can also be read
+   // through another vertex array, e.g. with the positions of consecutive vertices as instanced attributes.
+   template<size_t Index>
+   static void setAttributeFormat(GLuint vao, GLuint location, GLuint binding_index)
+   {
+      using Type = std::tuple_element_t<Index, std::tuple<typename Attributes::Type...>>;
+      setTypedFormat<Type>( vao, location, binding_index, Offsets[Index] );
+   }
+
+   // A single attribute is already laid out as the vertices, so its array is returned without a copy.
+   // Otherwise, the attributes are interleaved into the packed buffer, which keeps its capacity between the calls.
+   [[nodiscard]] static const void* pack(
+      std::vector<uint8_t>& packed,
+      const std::vector<typename Attributes::Type>&... attributes
+   )
+   {
+      if constexpr (AttributeNum == 1) return (attributes.data(), ...);
+      else {
+         const size_t vertex_num = std::min( { attributes.size()... } );
+         packed.resize( vertex_num * Stride );
+         for (size_t i = 0; i < vertex_num; ++i) {
+            const Vertex vertex( attributes[i]... );
+            std::memcpy( packed.data() + i * Stride, &vertex, sizeof( Vertex ) );
+         }
+         return packed.data();
+      }
+   }
+
+private:
+   template<size_t... Indices>
+   static void setFormat(GLuint vao, GLuint binding_index, std::index_sequence<Indices...>)
+   {
+      (setTypedFormat<typename Attributes::Type>( vao, Attributes::Location, binding_index, Offsets[Indices] ), ...);
+   }
+
+   template<typename T>
+   static void setTypedFormat(GLuint vao, GLuint location, GLuint binding_index, GLuint offset)
+   {
+      using Format = VertexAttributeFormat<T>;
+      // The integral scalars such as an index are read as integers, not converted to floats.
+      if constexpr (std::is_integral_v<T>) {
+         glVertexArrayAttribIFormat( vao, location, Format::ComponentNum, Format::ComponentType, offset );
+      }
+      else {
+         glVertexArrayAttribFormat( vao, location, Format::ComponentNum, Format::ComponentType, Format::Normalized, offset );
+      }
+      glEnableVertexArrayAttrib( vao, location );
+      glVertexArrayAttribBinding( vao, location, binding_index );
+   }
+};
\ No newline at end of file
@@ -16,6 +16,8 @@
 #include <gtc/type_ptr.hpp>
 #include <gtc/matrix_transform.hpp>
 #include <gtc/quaternion.hpp>
+#include <gtc/type_precision.hpp>
+#include <gtc/packing.hpp>
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <gtx/quaternion.hpp>
@@ -31,6 +33,13 @@
 #include <sstream>
 #include <fstream>
 #include <chrono>
+#include <ctime>
+#include <memory>
+#include <functional>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "ProjectPath.h"
 
@@ -1,8 +1,144 @@
 #include "Renderer.h"
+#include "Profiler.h"
+#include <charconv>
+#include <cstring>
 
-int main()
+// It reports the option and returns false if the whole value is not an integer in the range of int.
+bool parseInteger(const std::string& option, const char* value, int& integer)
 {
-   RendererGL renderer;
+   const char* end = value + std::strlen( value );
+   const auto result = std::from_chars( value, end, integer );
+   if (result.ec != std::errc() || result.ptr != end) {
+      std::cerr << "The value of " << option << " has to be an integer: " << value << "\n";
+      return false;
+   }
+   return true;
+}
+
+// It inserts the index of a renderer before the extension, so the renderers do not write into the same file.
+std::string getIndexedPath(const std::string& path, int index)
+{
+   const size_t dot = path.find_last_of( '.' );
+   const size_t slash = path.find_last_of( "/\\" );
+   if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+      return path + "_" + std::to_string( index );
+   }
+   return path.substr( 0, dot ) + "_" + std::to_string( index ) + path.substr( dot );
+}
+
+// Every renderer owns its window and context, so each one renders its benchmark on its own thread. The profiled zones
+// of all threads are in one registry, so they are dumped once into a single trace after all renderers finish.
+bool benchmarkConcurrently(const RendererGL::Options& options, int renderer_num, int frame_num)
+{
+   std::vector<std::unique_ptr<RendererGL>> renderers;
+   for (int i = 0; i < renderer_num; ++i) {
+      RendererGL::Options renderer_options = options;
+      renderer_options.TracePath.clear();
+      if (!options.CapturePath.empty()) renderer_options.CapturePath = getIndexedPath( options.CapturePath, i );
+      renderers.emplace_back( std::make_unique<RendererGL>( renderer_options ) );
+   }
+   // A context can be current on only one thread, and the last created one is current on this thread.
+   glfwMakeContextCurrent( nullptr );
+
+   std::vector<int> results( renderer_num, 0 );
+   std::vector<std::thread> workers;
+   const auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < renderer_num; ++i) {
+      workers.emplace_back( [&renderers, &results, i, frame_num]() { results[i] = renderers[i]->benchmark( frame_num ); } );
+   }
+   for (auto& worker : workers) worker.join();
+   const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+   if (Profiler::getZoneNum() > 0) Profiler::dump( options.TracePath );
+   std::cout << "Benchmark: " << renderer_num << " renderers rendered " << renderer_num * frame_num << " frames in "
+      << elapsed.count() << " s (" << static_cast<double>(renderer_num * frame_num) / elapsed.count() << " fps in total)\n";
+   return std::all_of( results.begin(), results.end(), [](int result) { return result != 0; } );
+}
+
+int main(int argc, char** argv)
+{
+   RendererGL::Options options;
+   bool benchmark = false;
+   int frame_num = 1000;
+   int renderer_num = 1;
+   std::vector<std::string> texture_file_paths;
+   for (int i = 1; i < argc; ++i) {
+      const std::string argument( argv[i] );
+      if (argument == "--benchmark" || argument == "--headless") {
+         benchmark = true;
+         if (argument == "--headless") options.Headless = true;
+         if (i + 1 < argc && std::isdigit( static_cast<uchar>(argv[i + 1][0]) )) {
+            if (!parseInteger( argument, argv[++i], frame_num )) return 1;
+         }
+      }
+      else if (argument == "--capture" && i + 1 < argc) options.CapturePath = argv[++i];
+      else if (argument == "--trace" && i + 1 < argc) options.TracePath = argv[++i];
+      else if (argument == "--multi-viewport") options.MultiViewport = true;
+      else if (argument == "--cached-layers") options.CachedLayers = true;
+      else if (argument == "--thick-lines") options.ThickLines = true;
+      else if (argument == "--frames-in-flight" && i + 1 < argc) {
+         if (!parseInteger( argument, argv[++i], options.MaxFramesInFlight )) return 1;
+      }
+      else if (argument == "--swap-interval" && i + 1 < argc) {
+         if (!parseInteger( argument, argv[++i], options.SwapInterval )) return 1;
+      }
+      else if (argument == "--render-thread") options.RenderThread = true;
+      else if (argument == "--renderers" && i + 1 < argc) {
+         if (!parseInteger( argument, argv[++i], renderer_num )) return 1;
+         renderer_num = std::max( renderer_num, 1 );
+      }
+      else if (argument == "--record" && i + 1 < argc) options.RecordPath = argv[++i];
+      else if (argument == "--replay" && i + 1 < argc) options.ReplayPath = argv[++i];
+      else if (argument == "--replay-speed" && i + 1 < argc) {
+         const std::string speed( argv[++i] );
+         if (speed == "max") options.ReplaySpeed = InputRecorder::REPLAY_SPEED::MAXIMUM;
+         else if (speed == "recorded") options.ReplaySpeed = InputRecorder::REPLAY_SPEED::RECORDED;
+         else {
+            std::cerr << "The value of " << argument << " has to be max or recorded: " << speed << "\n";
+            return 1;
+         }
+      }
+      else if (argument == "--trajectories" && i + 1 < argc) {
+         if (!parseInteger( argument, argv[++i], options.TrajectoryNum )) return 1;
+      }
+      else if (argument == "--vertex-format" && i + 1 < argc) {
+         const std::string format( argv[++i] );
+         if (format == "half") options.CurveVertexFormat = ObjectGL::VERTEX_FORMAT::HALF_XY;
+         else if (format == "unorm16") options.CurveVertexFormat = ObjectGL::VERTEX_FORMAT::UNORM16_XY;
+         else {
+            std::cerr << "The value of " << argument << " has to be half or unorm16: " << format << "\n";
+            return 1;
+         }
+      }
+      else if (argument == "--profiler-overhead") {
+         constexpr int zone_num = 100000;
+         for (int trial = 0; trial < 5; ++trial) {
+            std::cout << "Profiler overhead: " << Profiler::measureOverhead( zone_num ) << " ns per zone\n";
+         }
+         return 0;
+      }
+      else if (argument == "--texture-benchmark") {
+         texture_file_paths.assign( argv + i + 1, argv + argc );
+         break;
+      }
+      else if (argument == "--context-api" && i + 1 < argc) {
+         const std::string api( argv[++i] );
+         if (api == "egl") options.ContextCreationAPI = GLFW_EGL_CONTEXT_API;
+         else if (api == "osmesa") options.ContextCreationAPI = GLFW_OSMESA_CONTEXT_API;
+         else {
+            std::cerr << "The value of " << argument << " has to be egl or osmesa: " << api << "\n";
+            return 1;
+         }
+      }
+   }
+
+   if (benchmark && renderer_num > 1 && texture_file_paths.empty()) {
+      return benchmarkConcurrently( options, renderer_num, frame_num ) ? 0 : 1;
+   }
+
+   RendererGL renderer( options );
+   if (!texture_file_paths.empty()) return renderer.benchmarkTextureLoading( texture_file_paths ) ? 0 : 1;
+   if (benchmark) return renderer.benchmark( frame_num ) ? 0 : 1;
+
    renderer.play();
    return 0;
 }
\ No newline at end of file
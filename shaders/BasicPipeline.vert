@@ -4,6 +4,8 @@ uniform mat4 WorldMatrix;
 uniform mat4 ViewMatrix;
 uniform mat4 ProjectionMatrix;
 uniform mat4 ModelViewProjectionMatrix;
+uniform vec3 VertexOffset;
+uniform vec3 VertexScale;
 
 layout (location = 0) in vec3 v_position;
 layout (location = 1) in vec3 v_normal;
@@ -15,12 +17,13 @@ out vec2 tex_coord;
 
 void main()
 {   
-   vec4 e_position = ViewMatrix * WorldMatrix * vec4(v_position, 1.0f);
+   vec3 position = VertexOffset + VertexScale * v_position;
+   vec4 e_position = ViewMatrix * WorldMatrix * vec4(position, 1.0f);
    vec4 e_normal = transpose( inverse( ViewMatrix * WorldMatrix ) ) * vec4(v_normal, 1.0f);
    position_in_ec = e_position.xyz;
    normal_in_ec = normalize( e_normal.xyz );
 
    tex_coord = v_tex_coord;  
 
-   gl_Position = ModelViewProjectionMatrix * vec4(v_position, 1.0f);
+   gl_Position = ModelViewProjectionMatrix * vec4(position, 1.0f);
 }
\ No newline at end of file
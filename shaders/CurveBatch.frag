@@ -0,0 +1,10 @@
+#version 460
+
+flat in vec4 curve_color;
+
+layout (location = 0) out vec4 final_color;
+
+void main()
+{
+   final_color = curve_color;
+}
\ No newline at end of file
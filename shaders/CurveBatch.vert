@@ -0,0 +1,19 @@
+#version 460
+
+uniform mat4 ModelViewProjectionMatrix;
+
+layout (binding = 0, std430) readonly buffer CurveColors
+{
+   vec4 Colors[];
+};
+
+layout (location = 0) in vec3 v_position;
+layout (location = 3) in uint v_curve_index;
+
+flat out vec4 curve_color;
+
+void main()
+{
+   curve_color = Colors[v_curve_index];
+   gl_Position = ModelViewProjectionMatrix * vec4(v_position, 1.0f);
+}
\ No newline at end of file
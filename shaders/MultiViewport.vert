@@ -0,0 +1,29 @@
+#version 460
+
+uniform mat4 WorldMatrix;
+uniform mat4 ViewMatrix;
+uniform mat4 ProjectionMatrix;
+uniform mat4 ModelViewProjectionMatrix;
+uniform vec3 VertexOffset;
+uniform vec3 VertexScale;
+
+layout (location = 0) in vec3 v_position;
+layout (location = 1) in vec3 v_normal;
+layout (location = 2) in vec2 v_tex_coord;
+
+out vec3 vs_position_in_ec;
+out vec3 vs_normal_in_ec;
+out vec2 vs_tex_coord;
+
+void main()
+{   
+   vec3 position = VertexOffset + VertexScale * v_position;
+   vec4 e_position = ViewMatrix * WorldMatrix * vec4(position, 1.0f);
+   vec4 e_normal = transpose( inverse( ViewMatrix * WorldMatrix ) ) * vec4(v_normal, 1.0f);
+   vs_position_in_ec = e_position.xyz;
+   vs_normal_in_ec = normalize( e_normal.xyz );
+
+   vs_tex_coord = v_tex_coord;
+
+   gl_Position = ModelViewProjectionMatrix * vec4(position, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 460
+
+struct MateralInfo {
+   vec4 EmissionColor;
+   vec4 AmbientColor;
+   vec4 DiffuseColor;
+   vec4 SpecularColor;
+   float SpecularExponent;
+};
+uniform MateralInfo Material;
+
+uniform float LineWidth;
+
+in vec2 position_in_pixels;
+flat in vec2 start_in_pixels;
+flat in vec2 end_in_pixels;
+
+layout (location = 0) out vec4 final_color;
+
+void main()
+{
+   // The distance to the segment is the signed distance of a capsule, which rounds the caps and the joins.
+   vec2 to_position = position_in_pixels - start_in_pixels;
+   vec2 segment = end_in_pixels - start_in_pixels;
+   float t = clamp( dot( to_position, segment ) / max( dot( segment, segment ), 1e-8f ), 0.0f, 1.0f );
+   float distance = length( to_position - t * segment );
+
+   // The coverage falls from one to zero over the pixel across the edge.
+   float coverage = clamp( 0.5f * LineWidth - distance + 0.5f, 0.0f, 1.0f );
+   if (coverage <= 0.0f) discard;
+
+   final_color = vec4(Material.DiffuseColor.rgb, Material.DiffuseColor.a * coverage);
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#version 460
+
+uniform mat4 ModelViewProjectionMatrix;
+uniform vec3 VertexOffset;
+uniform vec3 VertexScale;
+uniform vec2 ViewportSize;
+uniform float LineWidth;
+
+layout (location = 0) in vec3 v_start;
+layout (location = 1) in vec3 v_end;
+
+out vec2 position_in_pixels;
+flat out vec2 start_in_pixels;
+flat out vec2 end_in_pixels;
+
+vec2 toPixels(in vec3 position)
+{
+   vec4 clip_position = ModelViewProjectionMatrix * vec4(VertexOffset + VertexScale * position, 1.0f);
+   return (clip_position.xy / clip_position.w * 0.5f + 0.5f) * ViewportSize;
+}
+
+void main()
+{
+   start_in_pixels = toPixels( v_start );
+   end_in_pixels = toPixels( v_end );
+
+   // The quad covers the capsule around the segment and a pixel more for the anti-aliased edge.
+   // The four vertices of the triangle strip are its corners.
+   vec2 direction = end_in_pixels - start_in_pixels;
+   float segment_length = length( direction );
+   direction = segment_length > 1e-4f ? direction / segment_length : vec2(1.0f, 0.0f);
+   vec2 normal = vec2(-direction.y, direction.x);
+   float radius = 0.5f * LineWidth + 1.0f;
+   float along = (gl_VertexID & 1) == 0 ? -radius : segment_length + radius;
+   float side = (gl_VertexID & 2) == 0 ? -radius : radius;
+   position_in_pixels = start_in_pixels + along * direction + side * normal;
+
+   gl_Position = vec4(position_in_pixels / ViewportSize * 2.0f - 1.0f, 0.0f, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+   std::atomic<uint64_t> AllocationNum{ 0 };
+   std::atomic<uint64_t> AllocatedBytes{ 0 };
+
+   // The frames are counted per thread, so the renderers on other threads do not add to them.
+   thread_local uint64_t ThreadAllocationNum = 0;
+   thread_local uint64_t ThreadAllocatedBytes = 0;
+   thread_local uint64_t FrameStartAllocationNum = 0;
+   thread_local uint64_t FrameStartAllocatedBytes = 0;
+}
+
+bool AllocationCounter::isEnabled()
+{
+#ifdef TRACK_ALLOCATIONS
+   return true;
+#else
+   return false;
+#endif
+}
+
+uint64_t AllocationCounter::getAllocationNum()
+{
+   return AllocationNum.load( std::memory_order_relaxed );
+}
+
+uint64_t AllocationCounter::getAllocatedBytes()
+{
+   return AllocatedBytes.load( std::memory_order_relaxed );
+}
+
+void AllocationCounter::beginFrame()
+{
+   FrameStartAllocationNum = ThreadAllocationNum;
+   FrameStartAllocatedBytes = ThreadAllocatedBytes;
+}
+
+uint64_t AllocationCounter::getFrameAllocationNum()
+{
+   return ThreadAllocationNum - FrameStartAllocationNum;
+}
+
+uint64_t AllocationCounter::getFrameAllocatedBytes()
+{
+   return ThreadAllocatedBytes - FrameStartAllocatedBytes;
+}
+
+#ifdef TRACK_ALLOCATIONS
+namespace
+{
+   void* allocate(std::size_t size)
+   {
+      AllocationNum.fetch_add( 1, std::memory_order_relaxed );
+      AllocatedBytes.fetch_add( size, std::memory_order_relaxed );
+      ThreadAllocationNum++;
+      ThreadAllocatedBytes += size;
+      if (size == 0) size = 1;
+      while (true) {
+         if (void* pointer = std::malloc( size )) return pointer;
+         const std::new_handler handler = std::get_new_handler();
+         if (handler == nullptr) throw std::bad_alloc();
+         handler();
+      }
+   }
+
+   void* allocate(std::size_t size, std::align_val_t alignment)
+   {
+      AllocationNum.fetch_add( 1, std::memory_order_relaxed );
+      AllocatedBytes.fetch_add( size, std::memory_order_relaxed );
+      ThreadAllocationNum++;
+      ThreadAllocatedBytes += size;
+      const auto align = static_cast<std::size_t>(alignment);
+      const std::size_t aligned_size = (std::max<std::size_t>( size, 1 ) + align - 1) / align * align;
+#ifdef _MSC_VER
+      void* pointer = _aligned_malloc( aligned_size, align );
+#else
+      void* pointer = std::aligned_alloc( align, aligned_size );
+#endif
+      if (pointer == nullptr) throw std::bad_alloc();
+      return pointer;
+   }
+
+   void deallocate(void* pointer, std::align_val_t)
+   {
+#ifdef _MSC_VER
+      _aligned_free( pointer );
+#else
+      std::free( pointer );
+#endif
+   }
+}
+
+void* operator new(std::size_t size) { return allocate( size ); }
+void* operator new[](std::size_t size) { return allocate( size ); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+   try { return allocate( size ); }
+   catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+   try { return allocate( size ); }
+   catch (...) { return nullptr; }
+}
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate( size, alignment ); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate( size, alignment ); }
+
+void operator delete(void* pointer) noexcept { std::free( pointer ); }
+void operator delete[](void* pointer) noexcept { std::free( pointer ); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free( pointer ); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free( pointer ); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free( pointer ); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free( pointer ); }
+void operator delete(void* pointer, std::align_val_t alignment) noexcept { deallocate( pointer, alignment ); }
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept { deallocate( pointer, alignment ); }
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept
+{
+   deallocate( pointer, alignment );
+}
+void operator delete[](void* pointer, std::size_t, std::align_val_t alignment) noexcept
+{
+   deallocate( pointer, alignment );
+}
+#endif
\ No newline at end of file
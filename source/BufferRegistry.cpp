@@ -0,0 +1,69 @@
+#include "BufferRegistry.h"
+
+BufferRegistry::~BufferRegistry()
+{
+   for (const auto& info : Buffers) {
+      if (info.Buffer != 0) glDeleteBuffers( 1, &info.Buffer );
+   }
+}
+
+int BufferRegistry::add(
+   const std::string& name,
+   GLenum target,
+   GLsizeiptr element_size,
+   GLsizeiptr element_num,
+   const void* data,
+   GLbitfield storage_flags,
+   GLint binding_index
+)
+{
+   BufferInfo info;
+   info.Name = name;
+   info.Target = target;
+   info.Size = element_size * element_num;
+   info.ElementSize = element_size;
+   info.StorageFlags = storage_flags;
+   info.BindingIndex = binding_index;
+   glCreateBuffers( 1, &info.Buffer );
+   glNamedBufferStorage( info.Buffer, info.Size, data, storage_flags );
+   Buffers.emplace_back( info );
+
+   const auto index = static_cast<int>(Buffers.size() - 1);
+   if (binding_index >= 0) bind( index );
+   return index;
+}
+
+void BufferRegistry::update(int index, GLsizeiptr first_element, GLsizeiptr element_num, const void* data)
+{
+   if (index < 0) return;
+
+   const BufferInfo& info = Buffers[index];
+   const GLintptr offset = info.ElementSize * first_element;
+   const GLsizeiptr size = std::min( info.ElementSize * element_num, info.Size - offset );
+   if (size <= 0) return;
+
+   glNamedBufferSubData( info.Buffer, offset, size, data );
+}
+
+void BufferRegistry::orphan(int index)
+{
+   if (index < 0) return;
+
+   glInvalidateBufferData( Buffers[index].Buffer );
+}
+
+void BufferRegistry::bind(int index) const
+{
+   if (index < 0) return;
+
+   const BufferInfo& info = Buffers[index];
+   if (info.BindingIndex >= 0) glBindBufferBase( info.Target, static_cast<GLuint>(info.BindingIndex), info.Buffer );
+   else glBindBuffer( info.Target, info.Buffer );
+}
+
+GLsizeiptr BufferRegistry::getMemorySize() const
+{
+   GLsizeiptr size = 0;
+   for (const auto& info : Buffers) size += info.Size;
+   return size;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include "CompactCurveTable.h"
+
+CompactCurveTable::CompactCurveTable() : Offset( 0.0f ), Step( 1.0f ), ErrorBound( 0.0f )
+{
+}
+
+void CompactCurveTable::encode(const std::vector<glm::vec3>& samples)
+{
+   clear();
+   if (samples.empty()) return;
+
+   glm::vec2 min_point( samples[0] ), max_point( samples[0] );
+   for (const auto& sample : samples) {
+      min_point = glm::min( min_point, glm::vec2(sample) );
+      max_point = glm::max( max_point, glm::vec2(sample) );
+   }
+
+   const glm::vec2 extent = max_point - min_point;
+   Offset = min_point;
+   Step.x = extent.x > 0.0f ? extent.x / static_cast<float>(MaxValue) : 1.0f;
+   Step.y = extent.y > 0.0f ? extent.y / static_cast<float>(MaxValue) : 1.0f;
+
+   Samples.resize( samples.size() );
+   for (size_t i = 0; i < samples.size(); ++i) {
+      const glm::vec2 quantized = glm::round( (glm::vec2(samples[i]) - Offset) / Step );
+      Samples[i] = glm::u16vec2(glm::clamp( quantized, glm::vec2(0.0f), glm::vec2(static_cast<float>(MaxValue)) ));
+
+      const glm::vec3 decoded = getSample( static_cast<int>(i) );
+      ErrorBound = std::max( ErrorBound, glm::distance( glm::vec2(decoded), glm::vec2(samples[i]) ) );
+   }
+}
+
+void CompactCurveTable::clear()
+{
+   Offset = glm::vec2(0.0f);
+   Step = glm::vec2(1.0f);
+   ErrorBound = 0.0f;
+   Samples.clear();
+   Samples.shrink_to_fit();
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "CurveBatch.h"
+
+CurveBatch::CurveBatch(GLuint color_binding_index) :
+   ColorBindingIndex( color_binding_index ), VAO( 0 ), VBO( 0 ), IBO( 0 ), ColorBuffer( 0 ),
+   VertexBufferCapacity( 0 ), IndexBufferCapacity( 0 ), ColorBufferCapacity( 0 ), UploadedVertexNum( 0 ),
+   UploadedIndexNum( 0 ), ColorsChanged( false )
+{
+}
+
+CurveBatch::~CurveBatch()
+{
+   if (VAO != 0) glDeleteVertexArrays( 1, &VAO );
+   if (VBO != 0) glDeleteBuffers( 1, &VBO );
+   if (IBO != 0) glDeleteBuffers( 1, &IBO );
+   if (ColorBuffer != 0) glDeleteBuffers( 1, &ColorBuffer );
+}
+
+void CurveBatch::clear()
+{
+   // The buffers keep their capacity, so the next curves are uploaded without allocating the storage again.
+   Vertices.clear();
+   Indices.clear();
+   Colors.clear();
+   UploadedVertexNum = 0;
+   UploadedIndexNum = 0;
+   ColorsChanged = false;
+}
+
+int CurveBatch::addCurve(const std::vector<glm::vec3>& vertices, const glm::vec4& color)
+{
+   const auto curve_index = static_cast<GLuint>(Colors.size());
+   if (!Indices.empty()) Indices.emplace_back( RestartIndex );
+   for (const auto& vertex : vertices) {
+      Indices.emplace_back( static_cast<GLuint>(Vertices.size()) );
+      Vertices.emplace_back( vertex, curve_index );
+   }
+   Colors.emplace_back( color );
+   ColorsChanged = true;
+   return static_cast<int>(curve_index);
+}
+
+void CurveBatch::setColor(int curve_index, const glm::vec4& color)
+{
+   Colors[curve_index] = color;
+   ColorsChanged = true;
+}
+
+bool CurveBatch::reserveBuffer(GLuint& buffer, GLsizeiptr& capacity, GLsizeiptr size)
+{
+   if (buffer != 0 && size <= capacity) return false;
+
+   // The storage is immutable, so a larger buffer replaces the old one.
+   capacity = std::max( { size, 2 * capacity, static_cast<GLsizeiptr>(1024) } );
+   if (buffer != 0) glDeleteBuffers( 1, &buffer );
+   glCreateBuffers( 1, &buffer );
+   glNamedBufferStorage( buffer, capacity, nullptr, GL_DYNAMIC_STORAGE_BIT );
+   return true;
+}
+
+void CurveBatch::upload()
+{
+   if (VAO == 0) {
+      glCreateVertexArrays( 1, &VAO );
+      Layout::setFormat( VAO, 0 );
+   }
+
+   if (reserveBuffer( VBO, VertexBufferCapacity, static_cast<GLsizeiptr>(sizeof( Layout::Vertex ) * Vertices.size()) )) {
+      glVertexArrayVertexBuffer( VAO, 0, VBO, 0, Layout::Stride );
+      UploadedVertexNum = 0;
+   }
+   if (reserveBuffer( IBO, IndexBufferCapacity, static_cast<GLsizeiptr>(sizeof( GLuint ) * Indices.size()) )) {
+      glVertexArrayElementBuffer( VAO, IBO );
+      UploadedIndexNum = 0;
+   }
+   if (reserveBuffer( ColorBuffer, ColorBufferCapacity, static_cast<GLsizeiptr>(sizeof( glm::vec4 ) * Colors.size()) )) {
+      ColorsChanged = true;
+   }
+
+   if (UploadedVertexNum < Vertices.size()) {
+      glNamedBufferSubData(
+         VBO,
+         static_cast<GLintptr>(sizeof( Layout::Vertex ) * UploadedVertexNum),
+         static_cast<GLsizeiptr>(sizeof( Layout::Vertex ) * (Vertices.size() - UploadedVertexNum)),
+         Vertices.data() + UploadedVertexNum
+      );
+      UploadedVertexNum = Vertices.size();
+   }
+   if (UploadedIndexNum < Indices.size()) {
+      glNamedBufferSubData(
+         IBO,
+         static_cast<GLintptr>(sizeof( GLuint ) * UploadedIndexNum),
+         static_cast<GLsizeiptr>(sizeof( GLuint ) * (Indices.size() - UploadedIndexNum)),
+         Indices.data() + UploadedIndexNum
+      );
+      UploadedIndexNum = Indices.size();
+   }
+   if (ColorsChanged && !Colors.empty()) {
+      glNamedBufferSubData( ColorBuffer, 0, static_cast<GLsizeiptr>(sizeof( glm::vec4 ) * Colors.size()), Colors.data() );
+      ColorsChanged = false;
+   }
+}
+
+void CurveBatch::draw() const
+{
+   if (Indices.empty()) return;
+
+   glDrawElements( GL_LINE_STRIP, getIndexNum(), GL_UNSIGNED_INT, nullptr );
+}
\ No newline at end of file
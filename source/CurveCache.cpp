@@ -0,0 +1,96 @@
+#include "CurveCache.h"
+
+CurveCache::Key::Key(
+   const std::vector<glm::vec3>& position_control_points,
+   const std::vector<glm::vec3>& velocity_control_points,
+   std::vector<int> sample_nums
+) : SampleNums( std::move( sample_nums ) )
+{
+   ControlPoints.reserve( position_control_points.size() + velocity_control_points.size() );
+   ControlPoints.insert( ControlPoints.end(), position_control_points.begin(), position_control_points.end() );
+   ControlPoints.insert( ControlPoints.end(), velocity_control_points.begin(), velocity_control_points.end() );
+}
+
+size_t CurveCache::KeyHasher::operator()(const Key& key) const
+{
+   // FNV-1a over the raw bytes, which is fine because the control points come from the exact pixel positions.
+   uint64_t hash = 14695981039346656037ull;
+   const auto combine = [&hash](const void* data, size_t size)
+   {
+      const auto* bytes = static_cast<const uchar*>(data);
+      for (size_t i = 0; i < size; ++i) {
+         hash ^= bytes[i];
+         hash *= 1099511628211ull;
+      }
+   };
+   combine( key.ControlPoints.data(), sizeof( glm::vec3 ) * key.ControlPoints.size() );
+   combine( key.SampleNums.data(), sizeof( int ) * key.SampleNums.size() );
+   return static_cast<size_t>(hash);
+}
+
+CurveCache::CurveCache(size_t memory_budget) :
+   MemoryBudget( memory_budget ), MemoryUsage( 0 ), HitNum( 0 ), MissNum( 0 ), EvictionNum( 0 )
+{
+}
+
+size_t CurveCache::getBytes(const Key& key, const Tables& tables)
+{
+   return sizeof( Entry ) +
+      sizeof( glm::vec3 ) * (key.ControlPoints.size() + tables.Curve.size() + tables.Motion.size()) +
+      tables.CompactCurve.getMemorySize() + tables.CompactMotion.getMemorySize() +
+      sizeof( int ) * key.SampleNums.size();
+}
+
+const CurveCache::Tables* CurveCache::find(const Key& key)
+{
+   const auto it = Indices.find( key );
+   if (it == Indices.end()) {
+      MissNum++;
+      return nullptr;
+   }
+
+   HitNum++;
+   Entries.splice( Entries.begin(), Entries, it->second );
+   return &it->second->CachedTables;
+}
+
+void CurveCache::evict()
+{
+   while (MemoryUsage > MemoryBudget && !Entries.empty()) {
+      MemoryUsage -= Entries.back().Bytes;
+      Indices.erase( Entries.back().CacheKey );
+      Entries.pop_back();
+      EvictionNum++;
+   }
+}
+
+void CurveCache::insert(Key key, Tables tables)
+{
+   const size_t bytes = getBytes( key, tables );
+   if (bytes > MemoryBudget) return;
+
+   const auto it = Indices.find( key );
+   if (it != Indices.end()) {
+      MemoryUsage -= it->second->Bytes;
+      Entries.erase( it->second );
+      Indices.erase( it );
+   }
+
+   Entries.push_front( { std::move( key ), std::move( tables ), bytes } );
+   Indices.emplace( Entries.front().CacheKey, Entries.begin() );
+   MemoryUsage += bytes;
+   evict();
+}
+
+void CurveCache::clear()
+{
+   Entries.clear();
+   Indices.clear();
+   MemoryUsage = 0;
+}
+
+void CurveCache::setMemoryBudget(size_t memory_budget)
+{
+   MemoryBudget = memory_budget;
+   evict();
+}
\ No newline at end of file
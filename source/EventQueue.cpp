@@ -0,0 +1,76 @@
+#include "EventQueue.h"
+
+EventQueue::EventQueue(size_t capacity) :
+   Mask( getPowerOfTwo( capacity ) - 1 ), Slots( Mask + 1 ), Head( 0 ), CachedTail( 0 ), Tail( 0 ), CachedHead( 0 ),
+   FullNum( 0 ), Sleeping( false ), WakeRequested( false )
+{
+}
+
+size_t EventQueue::getPowerOfTwo(size_t capacity)
+{
+   size_t power = 2;
+   while (power < capacity) power <<= 1;
+   return power;
+}
+
+bool EventQueue::push(const Event& event)
+{
+   const size_t tail = Tail.load( std::memory_order_relaxed );
+   if (tail - CachedHead == Slots.size()) {
+      CachedHead = Head.load( std::memory_order_acquire );
+      if (tail - CachedHead == Slots.size()) {
+         FullNum.fetch_add( 1, std::memory_order_relaxed );
+         return false;
+      }
+   }
+
+   Slots[tail & Mask] = event;
+   // Both this store and the load of the sleeping flag are sequentially consistent, so either the consumer sees
+   // the new tail before it sleeps, or this thread sees that it sleeps and notifies it.
+   Tail.store( tail + 1, std::memory_order_seq_cst );
+   if (Sleeping.load( std::memory_order_seq_cst )) {
+      { std::lock_guard<std::mutex> lock( WakeLock ); }
+      Woken.notify_one();
+   }
+   return true;
+}
+
+bool EventQueue::pop(Event& event)
+{
+   const size_t head = Head.load( std::memory_order_relaxed );
+   if (head == CachedTail) {
+      CachedTail = Tail.load( std::memory_order_acquire );
+      if (head == CachedTail) return false;
+   }
+
+   event = Slots[head & Mask];
+   Head.store( head + 1, std::memory_order_release );
+   return true;
+}
+
+bool EventQueue::empty() const
+{
+   return Head.load( std::memory_order_relaxed ) == Tail.load( std::memory_order_seq_cst );
+}
+
+void EventQueue::wait(double timeout_seconds)
+{
+   std::unique_lock<std::mutex> lock( WakeLock );
+   Sleeping.store( true, std::memory_order_seq_cst );
+   Woken.wait_for(
+      lock,
+      std::chrono::duration<double>( timeout_seconds ),
+      [this]() { return WakeRequested || !empty(); }
+   );
+   Sleeping.store( false, std::memory_order_relaxed );
+   WakeRequested = false;
+}
+
+void EventQueue::wake()
+{
+   {
+      std::lock_guard<std::mutex> lock( WakeLock );
+      WakeRequested = true;
+   }
+   Woken.notify_one();
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "FrameCapturer.h"
+
+FrameCapturer::FrameCapturer(int buffer_num, int max_queued_frame_num) :
+   BufferNum( std::max( buffer_num, 1 ) ), MaxQueuedFrameNum( std::max( max_queued_frame_num, 1 ) ), Width( 0 ),
+   Height( 0 ), FrameRate( 60 ), NextBufferIndex( 0 ), AllocatedFrameNum( 0 ), Format( FORMAT::RAW_RGBA ),
+   StopRequested( false ), CapturedFrameNum( 0 )
+{
+}
+
+FrameCapturer::~FrameCapturer()
+{
+   finish();
+}
+
+bool FrameCapturer::start(const std::string& file_path, int width, int height, int frame_rate)
+{
+   finish();
+
+   File.open( file_path, std::ios::out | std::ios::binary | std::ios::trunc );
+   if (!File.is_open()) {
+      std::cerr << "Cannot open the capture file: " << file_path << "\n";
+      return false;
+   }
+
+   const std::string extension = ".y4m";
+   const bool is_y4m = file_path.size() >= extension.size() &&
+      file_path.compare( file_path.size() - extension.size(), extension.size(), extension ) == 0;
+   Format = is_y4m ? FORMAT::Y4M : FORMAT::RAW_RGBA;
+   Width = width;
+   Height = height;
+   FrameRate = frame_rate;
+   NextBufferIndex = 0;
+   AllocatedFrameNum = 0;
+   StopRequested = false;
+   CapturedFrameNum.store( 0, std::memory_order_relaxed );
+   if (Format == FORMAT::Y4M) {
+      File << "YUV4MPEG2 W" << Width << " H" << Height << " F" << FrameRate << ":1 Ip A1:1 C444\n";
+   }
+
+   PixelBuffers.resize( BufferNum );
+   for (auto& pixel_buffer : PixelBuffers) {
+      glCreateBuffers( 1, &pixel_buffer.Buffer );
+      glNamedBufferStorage( pixel_buffer.Buffer, static_cast<GLsizeiptr>(getFrameSize()), nullptr, GL_MAP_READ_BIT );
+   }
+
+   StartTime = std::chrono::steady_clock::now();
+   Writer = std::thread( &FrameCapturer::writeFrames, this );
+   return true;
+}
+
+void FrameCapturer::readBack(PixelBuffer& pixel_buffer)
+{
+   // The fence was inserted BufferNum frames ago, so it has usually signaled already.
+   while (glClientWaitSync( pixel_buffer.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000 ) == GL_TIMEOUT_EXPIRED) {}
+   glDeleteSync( pixel_buffer.Fence );
+   pixel_buffer.Fence = nullptr;
+
+   std::vector<uchar> frame;
+   {
+      std::unique_lock<std::mutex> lock( Lock );
+      FrameWritten.wait(
+         lock,
+         [this]() { return !FreeFrames.empty() || AllocatedFrameNum < MaxQueuedFrameNum; }
+      );
+      if (FreeFrames.empty()) AllocatedFrameNum++;
+      else {
+         frame = std::move( FreeFrames.back() );
+         FreeFrames.pop_back();
+      }
+   }
+   frame.resize( getFrameSize() );
+
+   const auto* pixels = static_cast<const uchar*>(glMapNamedBufferRange(
+      pixel_buffer.Buffer, 0, static_cast<GLsizeiptr>(getFrameSize()), GL_MAP_READ_BIT
+   ));
+   if (pixels != nullptr) std::copy( pixels, pixels + getFrameSize(), frame.begin() );
+   glUnmapNamedBuffer( pixel_buffer.Buffer );
+
+   {
+      std::lock_guard<std::mutex> lock( Lock );
+      QueuedFrames.emplace_back( std::move( frame ) );
+   }
+   FrameQueued.notify_one();
+}
+
+void FrameCapturer::capture()
+{
+   if (!isCapturing()) return;
+
+   PixelBuffer& pixel_buffer = PixelBuffers[NextBufferIndex];
+   if (pixel_buffer.Fence != nullptr) readBack( pixel_buffer );
+
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, pixel_buffer.Buffer );
+   glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+   glReadPixels( 0, 0, Width, Height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+   pixel_buffer.Fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+   NextBufferIndex = (NextBufferIndex + 1) % BufferNum;
+}
+
+void FrameCapturer::finish()
+{
+   if (!isCapturing()) return;
+
+   for (int i = 0; i < BufferNum; ++i) {
+      PixelBuffer& pixel_buffer = PixelBuffers[(NextBufferIndex + i) % BufferNum];
+      if (pixel_buffer.Fence != nullptr) readBack( pixel_buffer );
+   }
+   {
+      std::lock_guard<std::mutex> lock( Lock );
+      StopRequested = true;
+   }
+   FrameQueued.notify_one();
+   Writer.join();
+
+   const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - StartTime;
+   const uint64_t captured_frame_num = getCapturedFrameNum();
+   std::cout << "Captured " << captured_frame_num << " frames in " << elapsed.count() << " s ("
+      << static_cast<double>(captured_frame_num) / elapsed.count() << " captured fps)\n";
+
+   for (auto& pixel_buffer : PixelBuffers) glDeleteBuffers( 1, &pixel_buffer.Buffer );
+   PixelBuffers.clear();
+   QueuedFrames.clear();
+   FreeFrames.clear();
+   File.close();
+}
+
+void FrameCapturer::writeFrames()
+{
+   while (true) {
+      std::vector<uchar> frame;
+      {
+         std::unique_lock<std::mutex> lock( Lock );
+         FrameQueued.wait( lock, [this]() { return StopRequested || !QueuedFrames.empty(); } );
+         if (QueuedFrames.empty()) return;
+
+         frame = std::move( QueuedFrames.front() );
+         QueuedFrames.pop_front();
+      }
+
+      if (Format == FORMAT::Y4M) writeY4MFrame( frame );
+      else writeRawFrame( frame );
+
+      {
+         std::lock_guard<std::mutex> lock( Lock );
+         FreeFrames.emplace_back( std::move( frame ) );
+         CapturedFrameNum.fetch_add( 1, std::memory_order_relaxed );
+      }
+      FrameWritten.notify_one();
+   }
+}
+
+void FrameCapturer::writeRawFrame(const std::vector<uchar>& frame)
+{
+   // OpenGL returns the rows from the bottom, but the files store them from the top.
+   const size_t row_size = static_cast<size_t>(Width) * 4;
+   for (int y = Height - 1; y >= 0; --y) {
+      File.write( reinterpret_cast<const char*>(frame.data() + row_size * y), static_cast<std::streamsize>(row_size) );
+   }
+}
+
+void FrameCapturer::writeY4MFrame(const std::vector<uchar>& frame)
+{
+   // BT.601 with the limited range, which is what y4m readers assume by default.
+   const size_t plane_size = static_cast<size_t>(Width) * Height;
+   ConvertedFrame.resize( plane_size * 3 );
+   uchar* y_plane = ConvertedFrame.data();
+   uchar* u_plane = y_plane + plane_size;
+   uchar* v_plane = u_plane + plane_size;
+   for (int y = 0; y < Height; ++y) {
+      const uchar* row = frame.data() + static_cast<size_t>(Height - 1 - y) * Width * 4;
+      for (int x = 0; x < Width; ++x) {
+         const int r = row[x * 4], g = row[x * 4 + 1], b = row[x * 4 + 2];
+         const size_t index = static_cast<size_t>(y) * Width + x;
+         y_plane[index] = static_cast<uchar>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+         u_plane[index] = static_cast<uchar>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+         v_plane[index] = static_cast<uchar>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+      }
+   }
+   File << "FRAME\n";
+   File.write( reinterpret_cast<const char*>(ConvertedFrame.data()), static_cast<std::streamsize>(ConvertedFrame.size()) );
+}
\ No newline at end of file
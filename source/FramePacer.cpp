@@ -0,0 +1,151 @@
+#include "FramePacer.h"
+
+FramePacer::FramePacer(int max_frames_in_flight, int window_size) :
+   MaxFramesInFlight( std::max( max_frames_in_flight, 1 ) ), WindowSize( std::max( window_size, 1 ) ),
+   OldestFrameIndex( 0 ), FrameInFlightNum( 0 ), NextSampleIndex( 0 ), SampleNum( 0 ), FrameNum( 0 ),
+   BlockedFrameNum( 0 ), BlockedMilliseconds( 0.0 ), RejectedSampleNum( 0 ), GPUClockOffset( 0 )
+{
+   LatencySamples.resize( WindowSize, 0.0 );
+   SortedSamples.reserve( WindowSize );
+}
+
+FramePacer::~FramePacer()
+{
+   finish();
+}
+
+void FramePacer::start()
+{
+   finish();
+
+   Frames.resize( MaxFramesInFlight );
+   for (auto& frame : Frames) glCreateQueries( GL_TIMESTAMP, 1, &frame.Query );
+   OldestFrameIndex = 0;
+   FrameInFlightNum = 0;
+   NextSampleIndex = 0;
+   SampleNum = 0;
+   FrameNum = 0;
+   BlockedFrameNum = 0;
+   BlockedMilliseconds = 0.0;
+   RejectedSampleNum = 0;
+   calibrate();
+}
+
+void FramePacer::calibrate()
+{
+   // Reading GL_TIMESTAMP does not wait for the queued commands, so the offset only carries the cost of one call.
+   GLint64 gpu_time = 0;
+   glGetInteger64v( GL_TIMESTAMP, &gpu_time );
+   const int64_t cpu_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()
+   ).count();
+   GPUClockOffset = gpu_time - cpu_time;
+}
+
+bool FramePacer::retireOldestFrame(bool block)
+{
+   Frame& frame = Frames[OldestFrameIndex];
+   if (block) {
+      while (glClientWaitSync( frame.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000 ) == GL_TIMEOUT_EXPIRED) {}
+   }
+   else {
+      const GLenum result = glClientWaitSync( frame.Fence, 0, 0 );
+      if (result == GL_TIMEOUT_EXPIRED) return false;
+   }
+   glDeleteSync( frame.Fence );
+   frame.Fence = nullptr;
+
+   if (frame.ReflectsInput) {
+      // The query precedes the fence, so its result is available once the fence has signaled.
+      GLint64 completion_time = 0;
+      glGetQueryObjecti64v( frame.Query, GL_QUERY_RESULT, &completion_time );
+      const int64_t input_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+         frame.InputTime.time_since_epoch()
+      ).count();
+      const double latency = static_cast<double>(completion_time - GPUClockOffset - input_time) * 1e-6;
+      if (latency < 0.0) RejectedSampleNum++;
+      else {
+         LatencySamples[NextSampleIndex] = latency;
+         NextSampleIndex = (NextSampleIndex + 1) % WindowSize;
+         SampleNum = std::min( SampleNum + 1, WindowSize );
+      }
+   }
+
+   OldestFrameIndex = (OldestFrameIndex + 1) % MaxFramesInFlight;
+   FrameInFlightNum--;
+   return true;
+}
+
+void FramePacer::beginFrame()
+{
+   if (Frames.empty()) return;
+
+   // The finished frames are retired without waiting, so their latencies are collected as early as possible.
+   while (FrameInFlightNum > 0 && retireOldestFrame( false )) {}
+   if (FrameInFlightNum < MaxFramesInFlight) return;
+
+   const auto start = std::chrono::steady_clock::now();
+   retireOldestFrame( true );
+   const std::chrono::duration<double, std::milli> blocked = std::chrono::steady_clock::now() - start;
+   BlockedMilliseconds += blocked.count();
+   BlockedFrameNum++;
+}
+
+void FramePacer::endFrame(bool reflects_input, const std::chrono::steady_clock::time_point& input_time)
+{
+   if (Frames.empty()) return;
+
+   Frame& frame = Frames[(OldestFrameIndex + FrameInFlightNum) % MaxFramesInFlight];
+   glQueryCounter( frame.Query, GL_TIMESTAMP );
+   frame.Fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+   frame.ReflectsInput = reflects_input && input_time != std::chrono::steady_clock::time_point();
+   frame.InputTime = input_time;
+   FrameInFlightNum++;
+   FrameNum++;
+
+   // The two clocks drift apart slowly, so the offset is measured again from time to time.
+   if (FrameNum % CalibrationInterval == 0) calibrate();
+}
+
+void FramePacer::finish()
+{
+   if (Frames.empty()) return;
+
+   while (FrameInFlightNum > 0) retireOldestFrame( true );
+   for (auto& frame : Frames) glDeleteQueries( 1, &frame.Query );
+   Frames.clear();
+}
+
+FramePacer::Statistics FramePacer::getLatencyStatistics()
+{
+   Statistics statistics;
+   if (SampleNum == 0) return statistics;
+
+   SortedSamples.assign( LatencySamples.begin(), LatencySamples.begin() + SampleNum );
+   std::sort( SortedSamples.begin(), SortedSamples.end() );
+   double sum = 0.0;
+   for (const auto& sample : SortedSamples) sum += sample;
+   const auto p99_index = static_cast<size_t>(std::ceil( 0.99 * static_cast<double>(SortedSamples.size()) )) - 1;
+   statistics.AverageMilliseconds = sum / static_cast<double>(SortedSamples.size());
+   statistics.P99Milliseconds = SortedSamples[p99_index];
+   statistics.MaxMilliseconds = SortedSamples.back();
+   statistics.SampleNum = SampleNum;
+   return statistics;
+}
+
+void FramePacer::print()
+{
+   std::cout << "Frame pacing: " << FrameNum << " frames with at most " << MaxFramesInFlight
+      << " in flight, blocked before " << BlockedFrameNum << " frames for " << BlockedMilliseconds << " ms in total\n";
+   if (RejectedSampleNum > 0) {
+      std::cout << "Frame pacing: " << RejectedSampleNum << " negative latencies were dropped\n";
+   }
+   const Statistics statistics = getLatencyStatistics();
+   if (statistics.SampleNum == 0) return;
+
+   std::cout << "Frame pacing: input to GPU completion latency avg/p99/max " << std::fixed << std::setprecision( 3 )
+      << statistics.AverageMilliseconds << " / " << statistics.P99Milliseconds << " / " << statistics.MaxMilliseconds
+      << " ms over the last " << statistics.SampleNum << " input frames\n";
+   std::cout.unsetf( std::ios::fixed );
+   std::cout << std::setprecision( 6 );
+}
\ No newline at end of file
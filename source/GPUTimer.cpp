@@ -0,0 +1,107 @@
+#include "GPUTimer.h"
+
+GPUTimer::GPUTimer(int query_ring_size, int window_size) :
+   QueryRingSize( std::max( query_ring_size, 2 ) ), WindowSize( std::max( window_size, 1 ) ), RingIndex( 0 ),
+   FrameNum( 0 ), DroppedSampleNum( 0 )
+{
+   SortedSamples.reserve( WindowSize );
+}
+
+GPUTimer::~GPUTimer()
+{
+   destroyQueries();
+}
+
+void GPUTimer::destroyQueries()
+{
+   for (auto& pass : Passes) {
+      if (!pass.BeginQueries.empty()) glDeleteQueries( QueryRingSize, pass.BeginQueries.data() );
+      if (!pass.EndQueries.empty()) glDeleteQueries( QueryRingSize, pass.EndQueries.data() );
+      pass.BeginQueries.clear();
+      pass.EndQueries.clear();
+   }
+   Passes.clear();
+}
+
+int GPUTimer::addPass(const std::string& name)
+{
+   Pass pass;
+   pass.Name = name;
+   pass.BeginQueries.resize( QueryRingSize );
+   pass.EndQueries.resize( QueryRingSize );
+   pass.Pending.resize( QueryRingSize, false );
+   pass.Samples.resize( WindowSize, 0.0 );
+   pass.NextSampleIndex = 0;
+   pass.SampleNum = 0;
+   glCreateQueries( GL_TIMESTAMP, QueryRingSize, pass.BeginQueries.data() );
+   glCreateQueries( GL_TIMESTAMP, QueryRingSize, pass.EndQueries.data() );
+   Passes.emplace_back( std::move( pass ) );
+   return static_cast<int>(Passes.size() - 1);
+}
+
+void GPUTimer::beginFrame()
+{
+   RingIndex = static_cast<int>(FrameNum % static_cast<uint64_t>(QueryRingSize));
+   FrameNum++;
+   for (auto& pass : Passes) {
+      if (!pass.Pending[RingIndex]) continue;
+
+      pass.Pending[RingIndex] = false;
+      GLint available = GL_FALSE;
+      glGetQueryObjectiv( pass.EndQueries[RingIndex], GL_QUERY_RESULT_AVAILABLE, &available );
+      if (available == GL_FALSE) {
+         DroppedSampleNum++;
+         continue;
+      }
+
+      GLuint64 begin_time = 0, end_time = 0;
+      glGetQueryObjectui64v( pass.BeginQueries[RingIndex], GL_QUERY_RESULT, &begin_time );
+      glGetQueryObjectui64v( pass.EndQueries[RingIndex], GL_QUERY_RESULT, &end_time );
+      pass.Samples[pass.NextSampleIndex] = static_cast<double>(end_time - begin_time) * 1e-6;
+      pass.NextSampleIndex = (pass.NextSampleIndex + 1) % WindowSize;
+      pass.SampleNum = std::min( pass.SampleNum + 1, WindowSize );
+   }
+}
+
+void GPUTimer::begin(int pass_index)
+{
+   glQueryCounter( Passes[pass_index].BeginQueries[RingIndex], GL_TIMESTAMP );
+}
+
+void GPUTimer::end(int pass_index)
+{
+   glQueryCounter( Passes[pass_index].EndQueries[RingIndex], GL_TIMESTAMP );
+   Passes[pass_index].Pending[RingIndex] = true;
+}
+
+GPUTimer::Statistics GPUTimer::getStatistics(int pass_index)
+{
+   Statistics statistics;
+   const Pass& pass = Passes[pass_index];
+   if (pass.SampleNum == 0) return statistics;
+
+   SortedSamples.assign( pass.Samples.begin(), pass.Samples.begin() + pass.SampleNum );
+   std::sort( SortedSamples.begin(), SortedSamples.end() );
+   double sum = 0.0;
+   for (const auto& sample : SortedSamples) sum += sample;
+   const auto p99_index = static_cast<size_t>(std::ceil( 0.99 * static_cast<double>(SortedSamples.size()) )) - 1;
+   statistics.MinMilliseconds = SortedSamples.front();
+   statistics.AverageMilliseconds = sum / static_cast<double>(SortedSamples.size());
+   statistics.P99Milliseconds = SortedSamples[p99_index];
+   statistics.SampleNum = pass.SampleNum;
+   return statistics;
+}
+
+void GPUTimer::print()
+{
+   std::cout << "GPU time per pass over the last frames (min/avg/p99 in ms):\n";
+   for (int i = 0; i < getPassNum(); ++i) {
+      const Statistics statistics = getStatistics( i );
+      std::cout << " - " << std::left << std::setw( 16 ) << Passes[i].Name << std::right << std::fixed
+         << std::setprecision( 3 ) << statistics.MinMilliseconds << " / " << statistics.AverageMilliseconds
+         << " / " << statistics.P99Milliseconds << " (" << statistics.SampleNum << " samples)\n";
+   }
+   std::cout.unsetf( std::ios::fixed );
+   std::cout << std::setprecision( 6 );
+   if (DroppedSampleNum > 0) std::cout << " - " << DroppedSampleNum << " samples were not ready in time\n";
+}
\ No newline at end of file
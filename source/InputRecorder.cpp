@@ -0,0 +1,170 @@
+#include "InputRecorder.h"
+#include <cstring>
+
+InputRecorder::InputRecorder() :
+   RecordedEventNum( 0 ), Replaying( false ), ReplaySpeed( REPLAY_SPEED::RECORDED ), NextRecordIndex( 0 )
+{
+}
+
+InputRecorder::~InputRecorder()
+{
+   finishRecording();
+}
+
+bool InputRecorder::startRecording(const std::string& file_path, int width, int height)
+{
+   finishRecording();
+
+   RecordFile.open( file_path, std::ios::out | std::ios::binary | std::ios::trunc );
+   if (!RecordFile.is_open()) {
+      std::cerr << "Cannot open the input record file: " << file_path << "\n";
+      return false;
+   }
+
+   FileHeader header{};
+   std::memcpy( header.Magic, "MPIN", 4 );
+   header.Version = Version;
+   header.Width = static_cast<uint32_t>(width);
+   header.Height = static_cast<uint32_t>(height);
+   RecordFile.write( reinterpret_cast<const char*>(&header), sizeof( FileHeader ) );
+   LastRecordTime = std::chrono::steady_clock::now();
+   RecordedEventNum = 0;
+   return true;
+}
+
+void InputRecorder::record(const EventQueue::Event& event)
+{
+   // The size of the window is not an input, and replaying it would not resize the window.
+   if (!isRecording() ||
+       (event.Type != EventQueue::TYPE::KEY && event.Type != EventQueue::TYPE::MOUSE_BUTTON)) return;
+
+   const int64_t delta = std::chrono::duration_cast<std::chrono::microseconds>( event.Time - LastRecordTime ).count();
+   Record record{};
+   record.DeltaMicroseconds = static_cast<uint32_t>(std::clamp<int64_t>( delta, 0, 0xFFFFFFFF ));
+   record.Type = static_cast<uint8_t>(event.Type);
+   record.Action = static_cast<uint8_t>(event.Action);
+   record.Mods = static_cast<uint8_t>(event.Mods);
+   record.Key = event.Key;
+   record.Scancode = event.Scancode;
+   record.CursorX = static_cast<float>(event.CursorX);
+   record.CursorY = static_cast<float>(event.CursorY);
+   RecordFile.write( reinterpret_cast<const char*>(&record), sizeof( Record ) );
+   LastRecordTime = event.Time;
+   RecordedEventNum++;
+}
+
+void InputRecorder::finishRecording()
+{
+   if (!isRecording()) return;
+
+   RecordFile.close();
+   std::cout << "Recorded " << RecordedEventNum << " input events ("
+      << sizeof( FileHeader ) + RecordedEventNum * sizeof( Record ) << " bytes)\n";
+}
+
+bool InputRecorder::startReplaying(const std::string& file_path, REPLAY_SPEED speed, int width, int height)
+{
+   std::ifstream file( file_path, std::ios::in | std::ios::binary );
+   if (!file.is_open()) {
+      std::cerr << "Cannot open the input record file: " << file_path << "\n";
+      return false;
+   }
+
+   FileHeader header{};
+   file.read( reinterpret_cast<char*>(&header), sizeof( FileHeader ) );
+   if (!file || std::memcmp( header.Magic, "MPIN", 4 ) != 0 || header.Version != Version) {
+      std::cerr << "Not an input record file of version " << Version << ": " << file_path << "\n";
+      return false;
+   }
+   if (header.Width != static_cast<uint32_t>(width) || header.Height != static_cast<uint32_t>(height)) {
+      std::cerr << "The input was recorded in a " << header.Width << "x" << header.Height
+         << " window, so the cursor positions may not match.\n";
+   }
+
+   file.seekg( 0, std::ios::end );
+   const auto record_bytes = static_cast<uint64_t>(file.tellg()) - sizeof( FileHeader );
+   file.seekg( sizeof( FileHeader ), std::ios::beg );
+   if (record_bytes % sizeof( Record ) != 0) {
+      std::cerr << "The input record file ends with " << record_bytes % sizeof( Record )
+         << " bytes of a truncated event, which are ignored: " << file_path << "\n";
+   }
+
+   Records.clear();
+   RecordTimes.clear();
+   uint64_t time = 0;
+   Record record{};
+   while (file.read( reinterpret_cast<char*>(&record), sizeof( Record ) )) {
+      // Only the keys and the mouse buttons are recorded, and any other type would be dispatched as garbage.
+      if (record.Type != static_cast<uint8_t>(EventQueue::TYPE::KEY) &&
+          record.Type != static_cast<uint8_t>(EventQueue::TYPE::MOUSE_BUTTON)) {
+         std::cerr << "Invalid input record file, the event " << Records.size() << " has the unknown type "
+            << static_cast<int>(record.Type) << ": " << file_path << "\n";
+         Records.clear();
+         RecordTimes.clear();
+         return false;
+      }
+      time += record.DeltaMicroseconds;
+      Records.emplace_back( record );
+      RecordTimes.emplace_back( time );
+   }
+
+   Replaying = true;
+   ReplaySpeed = speed;
+   NextRecordIndex = 0;
+   ReplayStartTime = std::chrono::steady_clock::now();
+   std::cout << "Replay " << Records.size() << " input events at the "
+      << (speed == REPLAY_SPEED::MAXIMUM ? "maximum" : "recorded") << " speed\n";
+   return true;
+}
+
+uint64_t InputRecorder::getReplayMicroseconds() const
+{
+   return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - ReplayStartTime
+   ).count());
+}
+
+bool InputRecorder::getDueEvent(EventQueue::Event& event, bool idle)
+{
+   if (!Replaying || hasReplayFinished()) return false;
+   if (ReplaySpeed == REPLAY_SPEED::MAXIMUM) {
+      if (!idle) return false;
+   }
+   else if (getReplayMicroseconds() < RecordTimes[NextRecordIndex]) return false;
+
+   const Record& record = Records[NextRecordIndex];
+   event.Type = static_cast<EventQueue::TYPE>(record.Type);
+   event.Key = record.Key;
+   event.Scancode = record.Scancode;
+   event.Action = record.Action;
+   event.Mods = record.Mods;
+   event.CursorX = static_cast<double>(record.CursorX);
+   event.CursorY = static_cast<double>(record.CursorY);
+   event.Time = std::chrono::steady_clock::now();
+   NextRecordIndex++;
+   return true;
+}
+
+double InputRecorder::getSecondsToNextEvent() const
+{
+   if (!Replaying || hasReplayFinished() || ReplaySpeed == REPLAY_SPEED::MAXIMUM) return 0.0;
+
+   const uint64_t now = getReplayMicroseconds();
+   const uint64_t next = RecordTimes[NextRecordIndex];
+   return next > now ? static_cast<double>(next - now) * 1e-6 : 0.0;
+}
+
+void InputRecorder::finishReplaying()
+{
+   if (!Replaying) return;
+
+   const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - ReplayStartTime;
+   std::cout << "Replayed " << NextRecordIndex << " of " << Records.size() << " input events in " << elapsed.count()
+      << " s";
+   if (!Records.empty()) std::cout << " (recorded in " << static_cast<double>(RecordTimes.back()) * 1e-6 << " s)";
+   std::cout << "\n";
+   Replaying = false;
+   Records.clear();
+   RecordTimes.clear();
+   NextRecordIndex = 0;
+}
\ No newline at end of file
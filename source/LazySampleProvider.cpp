@@ -0,0 +1,89 @@
+#include "LazySampleProvider.h"
+
+LazySampleProvider::LazySampleProvider(int chunk_size, int window_chunk_num) :
+   ChunkSize( std::max( chunk_size, 1 ) ), WindowChunkNum( std::max( window_chunk_num, 2 ) ), SampleNum( 0 ),
+   ChunkNum( 0 ), CursorChunk( 0 ), NextChunk( 0 ), Generation( 0 ), StopRequested( false )
+{
+}
+
+LazySampleProvider::~LazySampleProvider()
+{
+   stop();
+}
+
+void LazySampleProvider::start(int sample_num, Generator generator)
+{
+   stop();
+
+   SampleNum = sample_num;
+   ChunkNum = (sample_num + ChunkSize - 1) / ChunkSize;
+   CursorChunk = 0;
+   NextChunk = 0;
+   Generation = 0;
+   StopRequested = false;
+   SampleGenerator = std::move( generator );
+   Window.resize( static_cast<size_t>(WindowChunkNum) * ChunkSize );
+   if (SampleNum > 0) Worker = std::thread( &LazySampleProvider::generate, this );
+}
+
+void LazySampleProvider::stop()
+{
+   if (!Worker.joinable()) return;
+
+   {
+      std::lock_guard<std::mutex> lock( Lock );
+      StopRequested = true;
+   }
+   CursorMoved.notify_all();
+   Worker.join();
+   SampleNum = 0;
+   ChunkNum = 0;
+}
+
+void LazySampleProvider::generate()
+{
+   std::unique_lock<std::mutex> lock( Lock );
+   while (true) {
+      CursorMoved.wait(
+         lock,
+         [this]() { return StopRequested || (NextChunk < ChunkNum && NextChunk < CursorChunk + WindowChunkNum); }
+      );
+      if (StopRequested) return;
+
+      const int chunk = NextChunk;
+      const int generation = Generation;
+      lock.unlock();
+
+      const int first = chunk * ChunkSize;
+      const int last = std::min( first + ChunkSize, SampleNum );
+      glm::vec3* slot = &Window[static_cast<size_t>(chunk % WindowChunkNum) * ChunkSize];
+      for (int i = first; i < last; ++i) slot[i - first] = SampleGenerator( i );
+
+      lock.lock();
+      if (generation == Generation) {
+         NextChunk++;
+         ChunkReady.notify_all();
+      }
+   }
+}
+
+glm::vec3 LazySampleProvider::getSample(int index)
+{
+   assert( isRunning() );
+
+   index = std::clamp( index, 0, SampleNum - 1 );
+   const int chunk = index / ChunkSize;
+
+   std::unique_lock<std::mutex> lock( Lock );
+   if (chunk < CursorChunk || NextChunk < chunk) {
+      // The cursor jumped out of the window, so the chunk being computed is no longer needed.
+      NextChunk = chunk;
+      Generation++;
+   }
+   if (chunk != CursorChunk) {
+      CursorChunk = chunk;
+      CursorMoved.notify_one();
+   }
+   ChunkReady.wait( lock, [this, chunk]() { return chunk < NextChunk; } );
+   return Window[static_cast<size_t>(chunk % WindowChunkNum) * ChunkSize + index % ChunkSize];
+}
\ No newline at end of file
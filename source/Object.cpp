@@ -1,7 +1,10 @@
 #include "Object.h"
 
 ObjectGL::ObjectGL() :
-   ImageBuffer( nullptr ), VAO( 0 ), VBO( 0 ), DrawMode( 0 ), VerticesCount( 0 ),
+   VAO( 0 ), VBO( 0 ), DrawMode( 0 ), VerticesCount( 0 ), VertexStride( 0 ),
+   VertexBufferSize( 0 ), VertexFormat( VERTEX_FORMAT::FLOAT_XYZ ), CurrentLayout( nullptr ),
+   EnabledAttributes( 0 ), SegmentVAO( 0 ), SetSegmentFormat( nullptr ),
+   VertexOffset( 0.0f ), VertexScale( 1.0f ),
    EmissionColor( 0.0f, 0.0f, 0.0f, 1.0f ),
    AmbientReflectionColor( 0.2f, 0.2f, 0.2f, 1.0f ),
    DiffuseReflectionColor( 0.8f, 0.8f, 0.8f, 1.0f ),
@@ -15,13 +18,10 @@ ObjectGL::~ObjectGL()
       glDeleteVertexArrays( 1, &VAO );
       glDeleteBuffers( 1, &VBO );
    }
+   if (SegmentVAO != 0) glDeleteVertexArrays( 1, &SegmentVAO );
    for (const auto& texture_id : TextureID) {
       if (texture_id != 0) glDeleteTextures( 1, &texture_id );
    }
-   for (const auto& buffer : CustomBuffers) {
-      if (buffer.second != 0) glDeleteBuffers( 1, &buffer.second );
-   }
-   delete [] ImageBuffer;
 }
 
 void ObjectGL::setEmissionColor(const glm::vec4& emission_color)
@@ -51,19 +51,8 @@ void ObjectGL::setSpecularReflectionExponent(const float& specular_reflection_ex
 
 bool ObjectGL::prepareTexture2DUsingFreeImage(const std::string& file_path, bool is_grayscale) const
 {
-   const FREE_IMAGE_FORMAT format = FreeImage_GetFileType( file_path.c_str(), 0 );
-   FIBITMAP* texture = FreeImage_Load( format, file_path.c_str() );
-   if (!texture) return false;
-
-   FIBITMAP* texture_converted;
-   const uint n_bits_per_pixel = FreeImage_GetBPP( texture );
-   const uint n_bits = is_grayscale ? 8 : 32;
-   if (is_grayscale) {
-      texture_converted = n_bits_per_pixel == n_bits ? texture : FreeImage_GetChannel( texture, FICC_RED );
-   }
-   else {
-      texture_converted = n_bits_per_pixel == n_bits ? texture : FreeImage_ConvertTo32Bits( texture );
-   }
+   FIBITMAP* texture_converted = TextureLoader::decode( file_path, is_grayscale );
+   if (!texture_converted) return false;
 
    const GLsizei width = FreeImage_GetWidth( texture_converted );
    const GLsizei height = FreeImage_GetHeight( texture_converted );
@@ -72,7 +61,6 @@ bool ObjectGL::prepareTexture2DUsingFreeImage(const std::string& file_path, bool
    glTextureSubImage2D( TextureID.back(), 0, 0, 0, width, height, is_grayscale ? GL_RED : GL_BGRA, GL_UNSIGNED_BYTE, data );
 
    FreeImage_Unload( texture_converted );
-   if (n_bits_per_pixel != n_bits) FreeImage_Unload( texture );
    return true;
 }
 
@@ -98,7 +86,14 @@ int ObjectGL::addTexture(const std::string& texture_file_path, bool is_grayscale
 
 void ObjectGL::addTexture(int width, int height, bool is_grayscale)
 {
-   GLuint texture_id = 0;
+   TextureID.emplace_back( 0 );
+   replaceTexture( getTextureNum() - 1, width, height, is_grayscale );
+}
+
+void ObjectGL::replaceTexture(int index, int width, int height, bool is_grayscale)
+{
+   GLuint& texture_id = TextureID[index];
+   if (texture_id != 0) glDeleteTextures( 1, &texture_id );
    glCreateTextures( GL_TEXTURE_2D, 1, &texture_id );
    glTextureStorage2D(
       texture_id,
@@ -112,7 +107,6 @@ void ObjectGL::addTexture(int width, int height, bool is_grayscale)
    glTextureParameteri( texture_id, GL_TEXTURE_WRAP_S, GL_REPEAT );
    glTextureParameteri( texture_id, GL_TEXTURE_WRAP_T, GL_REPEAT );
    glGenerateTextureMipmap( texture_id );
-   TextureID.emplace_back( texture_id );
 }
 
 int ObjectGL::addTexture(const uint8_t* image_buffer, int width, int height, bool is_grayscale)
@@ -132,31 +126,87 @@ int ObjectGL::addTexture(const uint8_t* image_buffer, int width, int height, boo
    return static_cast<int>(TextureID.size() - 1);
 }
 
-void ObjectGL::prepareTexture(bool normals_exist) const
+int ObjectGL::addTexture(TextureCache& cache, const std::string& texture_file_path, bool is_grayscale)
 {
-   const uint offset = normals_exist ? 6 : 3;
-   glVertexArrayAttribFormat( VAO, TextureLoc, 2, GL_FLOAT, GL_FALSE, offset * sizeof( GLfloat ) );
-   glEnableVertexArrayAttrib( VAO, TextureLoc );
-   glVertexArrayAttribBinding( VAO, TextureLoc, 0 );
+   GLuint texture_id = 0;
+   glCreateTextures( GL_TEXTURE_2D, 1, &texture_id );
+   if (!cache.upload( texture_id, texture_file_path, is_grayscale )) {
+      glDeleteTextures( 1, &texture_id );
+      std::cerr << "Could not read image file " << texture_file_path.c_str() << "\n";
+      return -1;
+   }
+
+   glTextureParameteri( texture_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+   glTextureParameteri( texture_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+   glTextureParameteri( texture_id, GL_TEXTURE_WRAP_S, GL_REPEAT );
+   glTextureParameteri( texture_id, GL_TEXTURE_WRAP_T, GL_REPEAT );
+   TextureID.emplace_back( texture_id );
+   return static_cast<int>(TextureID.size() - 1);
 }
 
-void ObjectGL::prepareNormal() const
+TextureLoader::Handle ObjectGL::addTexture(
+   TextureLoader& loader,
+   const std::string& texture_file_path,
+   bool is_grayscale
+)
 {
-   glVertexArrayAttribFormat( VAO, NormalLoc, 3, GL_FLOAT, GL_FALSE, 3 * sizeof( GLfloat ) );
-   glEnableVertexArrayAttrib( VAO, NormalLoc );
-   glVertexArrayAttribBinding( VAO, NormalLoc, 0 );
+   TextureLoader::Handle handle = loader.load( texture_file_path, is_grayscale );
+   TextureID.emplace_back( handle.getTexture() );
+   return handle;
 }
 
-void ObjectGL::prepareVertexBuffer(int n_bytes_per_vertex)
+void ObjectGL::prepareVertexBuffer(GLsizei stride, const void* data)
 {
+   VertexStride = stride;
+   VertexBufferSize = static_cast<GLsizeiptr>(stride) * VerticesCount;
    glCreateBuffers( 1, &VBO );
-   glNamedBufferStorage( VBO, sizeof( GLfloat ) * VerticesCount * n_bytes_per_vertex, DataBuffer.data(), GL_DYNAMIC_STORAGE_BIT );
-
+   glNamedBufferStorage( VBO, VertexBufferSize, data, GL_DYNAMIC_STORAGE_BIT );
    glCreateVertexArrays( 1, &VAO );
-   glVertexArrayVertexBuffer( VAO, 0, VBO, 0, n_bytes_per_vertex );
-   glVertexArrayAttribFormat( VAO, VertexLoc, 3, GL_FLOAT, GL_FALSE, 0 );
-   glEnableVertexArrayAttrib( VAO, VertexLoc );
-   glVertexArrayAttribBinding( VAO, VertexLoc, 0 );
+   CurrentLayout = nullptr;
+   EnabledAttributes = 0;
+}
+
+void ObjectGL::reserveVertexBuffer(GLsizeiptr size)
+{
+   if (size <= VertexBufferSize) return;
+
+   // The storage is immutable, so a larger buffer replaces the old one whose contents are about to be overwritten.
+   VertexBufferSize = std::max( size, 2 * VertexBufferSize );
+   glDeleteBuffers( 1, &VBO );
+   glCreateBuffers( 1, &VBO );
+   glNamedBufferStorage( VBO, VertexBufferSize, nullptr, GL_DYNAMIC_STORAGE_BIT );
+   glVertexArrayVertexBuffer( VAO, 0, VBO, 0, VertexStride );
+   updateSegmentArray();
+}
+
+GLuint ObjectGL::getSegmentVAO()
+{
+   if (SegmentVAO == 0 && VAO != 0) {
+      glCreateVertexArrays( 1, &SegmentVAO );
+      updateSegmentArray();
+   }
+   return SegmentVAO;
+}
+
+GLsizei ObjectGL::getSegmentNum() const
+{
+   if (DrawMode == GL_LINES) return VerticesCount / 2;
+   if (DrawMode == GL_LINE_STRIP) return std::max( VerticesCount - 1, 0 );
+   return 0;
+}
+
+void ObjectGL::updateSegmentArray() const
+{
+   if (SegmentVAO == 0 || SetSegmentFormat == nullptr) return;
+
+   // A line strip shares the end of a segment with the start of the next one, while separate lines do not.
+   const GLsizei segment_stride = DrawMode == GL_LINES ? 2 * VertexStride : VertexStride;
+   glVertexArrayVertexBuffer( SegmentVAO, 0, VBO, 0, segment_stride );
+   glVertexArrayVertexBuffer( SegmentVAO, 1, VBO, VertexStride, segment_stride );
+   glVertexArrayBindingDivisor( SegmentVAO, 0, 1 );
+   glVertexArrayBindingDivisor( SegmentVAO, 1, 1 );
+   SetSegmentFormat( SegmentVAO, SegmentStartLoc, 0 );
+   SetSegmentFormat( SegmentVAO, SegmentEndLoc, 1 );
 }
 
 void ObjectGL::getSquareObject(
@@ -198,24 +248,26 @@ void ObjectGL::setObject(GLenum draw_mode, int vertex_num)
 {
    DrawMode = draw_mode;
    VerticesCount = vertex_num;
-   DataBuffer.clear();
-   const int n_bytes_per_vertex = 3 * sizeof( GLfloat );
-   prepareVertexBuffer( n_bytes_per_vertex );
+   switch (VertexFormat) {
+      case VERTEX_FORMAT::HALF_XY:
+         prepareVertexBuffer( HalfPositionLayout::Stride, nullptr );
+         useLayout<HalfPositionLayout>();
+         break;
+      case VERTEX_FORMAT::UNORM16_XY:
+         prepareVertexBuffer( NormalizedPositionLayout::Stride, nullptr );
+         useLayout<NormalizedPositionLayout>();
+         break;
+      case VERTEX_FORMAT::FLOAT_XYZ:
+      default:
+         prepareVertexBuffer( PositionLayout::Stride, nullptr );
+         useLayout<PositionLayout>();
+         break;
+   }
 }
 
 void ObjectGL::setObject(GLenum draw_mode, const std::vector<glm::vec3>& vertices)
 {
-   DrawMode = draw_mode;
-   VerticesCount = 0;
-   DataBuffer.clear();
-   for (const auto& vertex : vertices) {
-      DataBuffer.push_back( vertex.x );
-      DataBuffer.push_back( vertex.y );
-      DataBuffer.push_back( vertex.z );
-      VerticesCount++;
-   }
-   const int n_bytes_per_vertex = 3 * sizeof( GLfloat );
-   prepareVertexBuffer( n_bytes_per_vertex );
+   setObject<PositionLayout>( draw_mode, vertices );
 }
 
 void ObjectGL::setObject(
@@ -224,21 +276,7 @@ void ObjectGL::setObject(
    const std::vector<glm::vec3>& normals
 )
 {
-   DrawMode = draw_mode;
-   VerticesCount = 0;
-   DataBuffer.clear();
-   for (size_t i = 0; i < vertices.size(); ++i) {
-      DataBuffer.push_back( vertices[i].x );
-      DataBuffer.push_back( vertices[i].y );
-      DataBuffer.push_back( vertices[i].z );
-      DataBuffer.push_back( normals[i].x );
-      DataBuffer.push_back( normals[i].y );
-      DataBuffer.push_back( normals[i].z );
-      VerticesCount++;
-   }
-   const int n_bytes_per_vertex = 6 * sizeof( GLfloat );
-   prepareVertexBuffer( n_bytes_per_vertex );
-   prepareNormal();
+   setObject<PositionNormalLayout>( draw_mode, vertices, normals );
 }
 
 void ObjectGL::setObject(
@@ -249,20 +287,7 @@ void ObjectGL::setObject(
    bool is_grayscale
 )
 {
-   DrawMode = draw_mode;
-   VerticesCount = 0;
-   DataBuffer.clear();
-   for (size_t i = 0; i < vertices.size(); ++i) {
-      DataBuffer.push_back( vertices[i].x );
-      DataBuffer.push_back( vertices[i].y );
-      DataBuffer.push_back( vertices[i].z );
-      DataBuffer.push_back( textures[i].x );
-      DataBuffer.push_back( textures[i].y );
-      VerticesCount++;
-   }
-   const int n_bytes_per_vertex = 5 * sizeof( GLfloat );
-   prepareVertexBuffer( n_bytes_per_vertex );
-   prepareTexture( false );
+   setObject<PositionTextureLayout>( draw_mode, vertices, textures );
    addTexture( texture_file_path, is_grayscale );
 }
 
@@ -273,24 +298,7 @@ void ObjectGL::setObject(
    const std::vector<glm::vec2>& textures
 )
 {
-   DrawMode = draw_mode;
-   VerticesCount = 0;
-   DataBuffer.clear();
-   for (size_t i = 0; i < vertices.size(); ++i) {
-      DataBuffer.push_back( vertices[i].x );
-      DataBuffer.push_back( vertices[i].y );
-      DataBuffer.push_back( vertices[i].z );
-      DataBuffer.push_back( normals[i].x );
-      DataBuffer.push_back( normals[i].y );
-      DataBuffer.push_back( normals[i].z );
-      DataBuffer.push_back( textures[i].x );
-      DataBuffer.push_back( textures[i].y );
-      VerticesCount++;
-   }
-   const int n_bytes_per_vertex = 8 * sizeof( GLfloat );
-   prepareVertexBuffer( n_bytes_per_vertex );
-   prepareNormal();
-   prepareTexture( true );
+   setObject<PositionNormalTextureLayout>( draw_mode, vertices, normals, textures );
 }
 
 void ObjectGL::setObject(
@@ -327,6 +335,26 @@ void ObjectGL::setSquareObject(
    setObject( draw_mode, square_vertices, square_normals, square_textures, texture_file_path, is_grayscale );
 }
 
+GLsizeiptr ObjectGL::getGPUMemorySize() const
+{
+   GLsizeiptr size = VertexBufferSize + CustomBuffers.getMemorySize();
+   for (const auto& texture_id : TextureID) {
+      if (texture_id == 0) continue;
+
+      GLint level_num = 0;
+      glGetTextureParameteriv( texture_id, GL_TEXTURE_IMMUTABLE_LEVELS, &level_num );
+      for (int level = 0; level < std::max( level_num, 1 ); ++level) {
+         GLint width = 0, height = 0, internal_format = 0;
+         glGetTextureLevelParameteriv( texture_id, level, GL_TEXTURE_WIDTH, &width );
+         glGetTextureLevelParameteriv( texture_id, level, GL_TEXTURE_HEIGHT, &height );
+         glGetTextureLevelParameteriv( texture_id, level, GL_TEXTURE_INTERNAL_FORMAT, &internal_format );
+         const GLsizeiptr texel_size = internal_format == GL_R8 ? 1 : 4;
+         size += texel_size * width * height;
+      }
+   }
+   return size;
+}
+
 void ObjectGL::transferUniformsToShader(const ShaderGL* shader)
 {
    glUniform4fv( shader->getMaterialEmissionLocation(), 1, &EmissionColor[0] );
@@ -334,39 +362,86 @@ void ObjectGL::transferUniformsToShader(const ShaderGL* shader)
    glUniform4fv( shader->getMaterialDiffuseLocation(), 1, &DiffuseReflectionColor[0] );
    glUniform4fv( shader->getMaterialSpecularLocation(), 1, &SpecularReflectionColor[0] );
    glUniform1f( shader->getMaterialSpecularExponentLocation(), SpecularReflectionExponent );
+   glUniform3fv( shader->getVertexOffsetLocation(), 1, &VertexOffset[0] );
+   glUniform3fv( shader->getVertexScaleLocation(), 1, &VertexScale[0] );
 }
 
 void ObjectGL::updateDataBuffer(const std::vector<glm::vec3>& vertices)
 {
-   assert( VBO != 0 );
+   updatePositionBuffer( vertices.data(), vertices.size() );
+}
 
-   VerticesCount = 0;
-   DataBuffer.clear();
-   for (const auto& vertex : vertices) {
-      DataBuffer.push_back( vertex.x );
-      DataBuffer.push_back( vertex.y );
-      DataBuffer.push_back( vertex.z );
-      VerticesCount++;
+void ObjectGL::updatePositionBuffer(const glm::vec3* vertices, size_t vertex_num)
+{
+   if (VertexFormat == VERTEX_FORMAT::HALF_XY) updateHalfDataBuffer( vertices, vertex_num );
+   else if (VertexFormat == VERTEX_FORMAT::UNORM16_XY) updateNormalizedDataBuffer( vertices, vertex_num );
+   else {
+      VertexOffset = glm::vec3(0.0f);
+      VertexScale = glm::vec3(1.0f);
+      updateDataBuffer<PositionLayout>( vertices, vertex_num );
    }
-   glNamedBufferSubData( VBO, 0, sizeof( GLfloat ) * DataBuffer.size(), DataBuffer.data() );
 }
 
-void ObjectGL::updateDataBuffer(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals)
+void ObjectGL::getBoundingBox(
+   const glm::vec3* vertices,
+   size_t vertex_num,
+   glm::vec2& min_point,
+   glm::vec2& max_point
+)
 {
-   assert( VBO != 0 );
+   min_point = glm::vec2(std::numeric_limits<float>::max());
+   max_point = glm::vec2(std::numeric_limits<float>::lowest());
+   for (size_t i = 0; i < vertex_num; ++i) {
+      min_point = glm::min( min_point, glm::vec2(vertices[i]) );
+      max_point = glm::max( max_point, glm::vec2(vertices[i]) );
+   }
+}
+
+void ObjectGL::updateHalfDataBuffer(const glm::vec3* vertices, size_t vertex_num)
+{
+   if (vertex_num == 0) {
+      VerticesCount = 0;
+      return;
+   }
+
+   // The positions are stored around the center, where the half floats are the most precise.
+   // A curve over 1920 pixels keeps its vertices within a half pixel.
+   glm::vec2 min_point, max_point;
+   getBoundingBox( vertices, vertex_num, min_point, max_point );
+   const glm::vec2 center = 0.5f * (min_point + max_point);
+   VertexOffset = glm::vec3(center, vertices[0].z);
+   VertexScale = glm::vec3(1.0f);
+   HalfPositions.resize( vertex_num );
+   for (size_t i = 0; i < vertex_num; ++i) {
+      HalfPositions[i].Bits.x = glm::packHalf1x16( vertices[i].x - center.x );
+      HalfPositions[i].Bits.y = glm::packHalf1x16( vertices[i].y - center.y );
+   }
+   updateDataBuffer<HalfPositionLayout>( HalfPositions );
+}
+
+void ObjectGL::updateNormalizedDataBuffer(const glm::vec3* vertices, size_t vertex_num)
+{
+   if (vertex_num == 0) {
+      VerticesCount = 0;
+      return;
+   }
 
-   VerticesCount = 0;
-   DataBuffer.clear();
-   for (size_t i = 0; i < vertices.size(); ++i) {
-      DataBuffer.push_back( vertices[i].x );
-      DataBuffer.push_back( vertices[i].y );
-      DataBuffer.push_back( vertices[i].z );
-      DataBuffer.push_back( normals[i].x );
-      DataBuffer.push_back( normals[i].y );
-      DataBuffer.push_back( normals[i].z );
-      VerticesCount++;
+   glm::vec2 min_point, max_point;
+   getBoundingBox( vertices, vertex_num, min_point, max_point );
+   const glm::vec2 extent = glm::max( max_point - min_point, glm::vec2(std::numeric_limits<float>::epsilon()) );
+   VertexOffset = glm::vec3(min_point, vertices[0].z);
+   VertexScale = glm::vec3(extent, 1.0f);
+   NormalizedPositions.resize( vertex_num );
+   for (size_t i = 0; i < vertex_num; ++i) {
+      const glm::vec2 normalized = (glm::vec2(vertices[i]) - min_point) / extent;
+      NormalizedPositions[i] = glm::u16vec2(glm::round( glm::clamp( normalized, 0.0f, 1.0f ) * 65535.0f ));
    }
-   glNamedBufferSubData( VBO, 0, sizeof( GLfloat ) * DataBuffer.size(), DataBuffer.data() );
+   updateDataBuffer<NormalizedPositionLayout>( NormalizedPositions );
+}
+
+void ObjectGL::updateDataBuffer(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals)
+{
+   updateDataBuffer<PositionNormalLayout>( vertices, normals );
 }
 
 void ObjectGL::updateDataBuffer(
@@ -375,62 +450,46 @@ void ObjectGL::updateDataBuffer(
    const std::vector<glm::vec2>& textures
 )
 {
-   assert( VBO != 0 );
-
-   VerticesCount = 0;
-   DataBuffer.clear();
-   for (size_t i = 0; i < vertices.size(); ++i) {
-      DataBuffer.push_back( vertices[i].x );
-      DataBuffer.push_back( vertices[i].y );
-      DataBuffer.push_back( vertices[i].z );
-      DataBuffer.push_back( normals[i].x );
-      DataBuffer.push_back( normals[i].y );
-      DataBuffer.push_back( normals[i].z );
-      DataBuffer.push_back( textures[i].x );
-      DataBuffer.push_back( textures[i].y );
-      VerticesCount++;
-   }
-   glNamedBufferSubData( VBO, 0, sizeof( GLfloat ) * DataBuffer.size(), DataBuffer.data() );
+   updateDataBuffer<PositionNormalTextureLayout>( vertices, normals, textures );
 }
 
-void ObjectGL::replaceVertices(
-   const std::vector<glm::vec3>& vertices,
-   bool normals_exist,
-   bool textures_exist
+void ObjectGL::updateDataBuffer(
+   const std::vector<glm::u16vec2>& normalized_vertices,
+   const glm::vec3& offset,
+   const glm::vec3& scale
 )
 {
-   assert( VBO != 0 );
+   VertexOffset = offset;
+   VertexScale = scale;
+   updateDataBuffer<NormalizedPositionLayout>( normalized_vertices );
+}
 
-   VerticesCount = 0;
-   int step = 3;
-   if (normals_exist) step += 3;
-   if (textures_exist) step += 2;
-   for (size_t i = 0; i < vertices.size(); ++i) {
-      DataBuffer[i * step] = vertices[i].x;
-      DataBuffer[i * step + 1] = vertices[i].y;
-      DataBuffer[i * step + 2] = vertices[i].z;
-      VerticesCount++;
-   }
-   glNamedBufferSubData( VBO, 0, sizeof( GLfloat ) * VerticesCount * step, DataBuffer.data() );
+void ObjectGL::replaceVertices(const std::vector<glm::vec3>& vertices)
+{
+   replacePositions( vertices.data(), vertices.size() );
 }
 
-void ObjectGL::replaceVertices(
-   const std::vector<float>& vertices,
-   bool normals_exist,
-   bool textures_exist
-)
+void ObjectGL::replaceVertices(const std::vector<float>& vertices)
+{
+   // The floats are read in place as the positions, so they are not copied into a vector of them first.
+   static_assert( sizeof( glm::vec3 ) == 3 * sizeof( float ), "The positions have to be tightly packed floats." );
+   replacePositions( reinterpret_cast<const glm::vec3*>(vertices.data()), vertices.size() / 3 );
+}
+
+void ObjectGL::replacePositions(const glm::vec3* vertices, size_t vertex_num)
 {
    assert( VBO != 0 );
 
-   VerticesCount = 0;
-   int step = 3;
-   if (normals_exist) step += 3;
-   if (textures_exist) step += 2;
-   for (size_t i = 0, j = 0; i < vertices.size(); i += 3, ++j) {
-      DataBuffer[j * step] = vertices[i];
-      DataBuffer[j * step + 1] = vertices[i + 1];
-      DataBuffer[j * step + 2] = vertices[i + 2];
-      VerticesCount++;
+   // The other attributes are kept in the packed vertices, unless the positions are the only attribute.
+   if (EnabledAttributes == (1u << VertexLoc)) {
+      updatePositionBuffer( vertices, vertex_num );
+      return;
+   }
+
+   vertex_num = std::min( vertex_num, PackedVertices.size() / static_cast<size_t>(VertexStride) );
+   for (size_t i = 0; i < vertex_num; ++i) {
+      std::memcpy( PackedVertices.data() + i * VertexStride, &vertices[i], sizeof( glm::vec3 ) );
    }
-   glNamedBufferSubData( VBO, 0, sizeof( GLfloat ) * VerticesCount * step, DataBuffer.data() );
+   VerticesCount = static_cast<GLsizei>(vertex_num);
+   glNamedBufferSubData( VBO, 0, static_cast<GLsizeiptr>(VertexStride) * VerticesCount, PackedVertices.data() );
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "Profiler.h"
+
+Profiler::ThreadBufferOwner::~ThreadBufferOwner()
+{
+   if (Buffer == nullptr) return;
+
+   std::lock_guard<std::mutex> lock( RegistryLock );
+   Buffer->Retired = true;
+   freeRetiredBuffers();
+}
+
+Profiler::ThreadBuffer* Profiler::getThreadBuffer()
+{
+   // The buffers are owned by the registry, so the zones of finished threads can still be dumped.
+   thread_local ThreadBufferOwner owner;
+   if (owner.Buffer == nullptr) {
+      std::lock_guard<std::mutex> lock( RegistryLock );
+      ThreadBuffers.emplace_back( std::make_unique<ThreadBuffer>( NextThreadID++, ThreadBufferCapacity ) );
+      owner.Buffer = ThreadBuffers.back().get();
+   }
+   return owner.Buffer;
+}
+
+void Profiler::freeRetiredBuffers()
+{
+   // A retired buffer is not written anymore, so it is kept only until its zones and dropped count are dumped.
+   ThreadBuffers.erase(
+      std::remove_if(
+         ThreadBuffers.begin(), ThreadBuffers.end(),
+         [](const std::unique_ptr<ThreadBuffer>& buffer)
+         {
+            return buffer->Retired &&
+               buffer->WrittenZoneNum.load( std::memory_order_relaxed ) ==
+                  buffer->ReadZoneNum.load( std::memory_order_relaxed ) &&
+               buffer->DroppedZoneNum.load( std::memory_order_relaxed ) == 0;
+         }
+      ),
+      ThreadBuffers.end()
+   );
+}
+
+void Profiler::record(const char* name, int64_t begin, int64_t end)
+{
+   ThreadBuffer* buffer = getThreadBuffer();
+   const uint64_t written_zone_num = buffer->WrittenZoneNum.load( std::memory_order_relaxed );
+   if (written_zone_num - buffer->ReadZoneNum.load( std::memory_order_acquire ) == ThreadBufferCapacity) {
+      buffer->DroppedZoneNum.fetch_add( 1, std::memory_order_relaxed );
+      return;
+   }
+
+   buffer->Zones[written_zone_num & (ThreadBufferCapacity - 1)] = { name, begin, end };
+   buffer->WrittenZoneNum.store( written_zone_num + 1, std::memory_order_release );
+}
+
+bool Profiler::dump(const std::string& file_path)
+{
+   std::ofstream file( file_path, std::ios::out | std::ios::trunc );
+   if (!file.is_open()) {
+      std::cerr << "Cannot open the trace file: " << file_path << "\n";
+      return false;
+   }
+
+   // The lock only keeps the registry and the dumps apart; the owner threads keep recording meanwhile.
+   std::lock_guard<std::mutex> lock( RegistryLock );
+   std::vector<uint64_t> end_zone_nums( ThreadBuffers.size() );
+   int64_t origin = std::numeric_limits<int64_t>::max();
+   for (size_t b = 0; b < ThreadBuffers.size(); ++b) {
+      const ThreadBuffer& buffer = *ThreadBuffers[b];
+      end_zone_nums[b] = buffer.WrittenZoneNum.load( std::memory_order_acquire );
+      for (uint64_t i = buffer.ReadZoneNum.load( std::memory_order_relaxed ); i < end_zone_nums[b]; ++i) {
+         origin = std::min( origin, buffer.Zones[i & (ThreadBufferCapacity - 1)].Begin );
+      }
+   }
+
+   uint64_t written_zone_num = 0;
+   file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+   file << std::fixed << std::setprecision( 3 );
+   for (size_t b = 0; b < ThreadBuffers.size(); ++b) {
+      ThreadBuffer& buffer = *ThreadBuffers[b];
+      for (uint64_t i = buffer.ReadZoneNum.load( std::memory_order_relaxed ); i < end_zone_nums[b]; ++i) {
+         const Zone& zone = buffer.Zones[i & (ThreadBufferCapacity - 1)];
+         if (written_zone_num++ > 0) file << ",";
+         file << "\n{\"name\":\"" << zone.Name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer.ThreadID
+            << ",\"ts\":" << static_cast<double>(zone.Begin - origin) * 1e-3
+            << ",\"dur\":" << static_cast<double>(zone.End - zone.Begin) * 1e-3 << "}";
+      }
+      // The slots are handed back to the owner thread only after they have been written out.
+      buffer.ReadZoneNum.store( end_zone_nums[b], std::memory_order_release );
+   }
+   file << "\n]}\n";
+
+   uint64_t dropped_zone_num = 0;
+   for (const auto& buffer : ThreadBuffers) {
+      dropped_zone_num += buffer->DroppedZoneNum.exchange( 0, std::memory_order_relaxed );
+   }
+   freeRetiredBuffers();
+   std::cout << "Dumped " << written_zone_num << " zones into " << file_path;
+   if (dropped_zone_num > 0) std::cout << ", and " << dropped_zone_num << " zones were dropped since the last dump";
+   std::cout << "\n";
+   return true;
+}
+
+uint64_t Profiler::getZoneNum()
+{
+   std::lock_guard<std::mutex> lock( RegistryLock );
+   uint64_t zone_num = 0;
+   for (const auto& buffer : ThreadBuffers) {
+      zone_num += buffer->WrittenZoneNum.load( std::memory_order_acquire ) -
+         buffer->ReadZoneNum.load( std::memory_order_relaxed );
+   }
+   return zone_num;
+}
+
+uint64_t Profiler::getDroppedZoneNum()
+{
+   std::lock_guard<std::mutex> lock( RegistryLock );
+   uint64_t dropped_zone_num = 0;
+   for (const auto& buffer : ThreadBuffers) {
+      dropped_zone_num += buffer->DroppedZoneNum.load( std::memory_order_relaxed );
+   }
+   return dropped_zone_num;
+}
+
+double Profiler::measureOverhead(int zone_num)
+{
+   zone_num = std::clamp( zone_num, 1, static_cast<int>(ThreadBufferCapacity) );
+
+   // The zones are recorded on a new thread, so they do not take the space of the buffer of the caller.
+   double overhead = 0.0;
+   std::thread measurer(
+      [zone_num, &overhead]()
+      {
+         const int64_t start = now();
+         for (int i = 0; i < zone_num; ++i) {
+            const Scope scope( "Profiler::measureOverhead" );
+         }
+         overhead = static_cast<double>(now() - start) / static_cast<double>(zone_num);
+      }
+   );
+   measurer.join();
+   return overhead;
+}
\ No newline at end of file
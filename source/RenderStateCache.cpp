@@ -0,0 +1,108 @@
+#include "RenderStateCache.h"
+
+RenderStateCache::RenderStateCache() :
+   Program( 0 ), VertexArray( 0 ), LineWidth( -1.0f ), PointSize( -1.0f ), ProgramKnown( false ),
+   VertexArrayKnown( false ), Blending( false ), BlendingKnown( false ), PrimitiveRestart( false ),
+   PrimitiveRestartKnown( false ), ShaderStorageBuffers{}, ShaderStorageBuffersKnown{}, IssuedCallNum( 0 ),
+   ElidedCallNum( 0 ), LastFrameIssuedCallNum( 0 ), LastFrameElidedCallNum( 0 ), TotalIssuedCallNum( 0 ),
+   TotalElidedCallNum( 0 )
+{
+}
+
+void RenderStateCache::useProgram(GLuint program)
+{
+   if (!update( ProgramKnown && Program == program )) return;
+
+   Program = program;
+   ProgramKnown = true;
+   glUseProgram( program );
+}
+
+void RenderStateCache::bindVertexArray(GLuint vertex_array)
+{
+   if (!update( VertexArrayKnown && VertexArray == vertex_array )) return;
+
+   VertexArray = vertex_array;
+   VertexArrayKnown = true;
+   glBindVertexArray( vertex_array );
+}
+
+void RenderStateCache::setLineWidth(float width)
+{
+   // The unknown width is negative, which is never a valid width.
+   if (!update( LineWidth == width )) return;
+
+   LineWidth = width;
+   glLineWidth( width );
+}
+
+void RenderStateCache::setPointSize(float size)
+{
+   if (!update( PointSize == size )) return;
+
+   PointSize = size;
+   glPointSize( size );
+}
+
+void RenderStateCache::setBlending(bool enabled)
+{
+   if (!update( BlendingKnown && Blending == enabled )) return;
+
+   Blending = enabled;
+   BlendingKnown = true;
+   if (enabled) glEnable( GL_BLEND );
+   else glDisable( GL_BLEND );
+}
+
+void RenderStateCache::setPrimitiveRestart(bool enabled)
+{
+   if (!update( PrimitiveRestartKnown && PrimitiveRestart == enabled )) return;
+
+   PrimitiveRestart = enabled;
+   PrimitiveRestartKnown = true;
+   if (enabled) glEnable( GL_PRIMITIVE_RESTART_FIXED_INDEX );
+   else glDisable( GL_PRIMITIVE_RESTART_FIXED_INDEX );
+}
+
+void RenderStateCache::bindShaderStorageBuffer(GLuint binding_index, GLuint buffer)
+{
+   const bool remembered = binding_index < RememberedBindingNum;
+   if (!update(
+      remembered && ShaderStorageBuffersKnown[binding_index] && ShaderStorageBuffers[binding_index] == buffer
+   )) return;
+
+   if (remembered) {
+      ShaderStorageBuffers[binding_index] = buffer;
+      ShaderStorageBuffersKnown[binding_index] = true;
+   }
+   glBindBufferBase( GL_SHADER_STORAGE_BUFFER, binding_index, buffer );
+}
+
+void RenderStateCache::invalidate()
+{
+   ProgramKnown = false;
+   VertexArrayKnown = false;
+   BlendingKnown = false;
+   PrimitiveRestartKnown = false;
+   ShaderStorageBuffersKnown.fill( false );
+   LineWidth = -1.0f;
+   PointSize = -1.0f;
+}
+
+void RenderStateCache::beginFrame()
+{
+   LastFrameIssuedCallNum = IssuedCallNum;
+   LastFrameElidedCallNum = ElidedCallNum;
+   TotalIssuedCallNum += IssuedCallNum;
+   TotalElidedCallNum += ElidedCallNum;
+   IssuedCallNum = 0;
+   ElidedCallNum = 0;
+}
+
+void RenderStateCache::print() const
+{
+   const uint64_t total_call_num = getTotalIssuedCallNum() + getTotalElidedCallNum();
+   std::cout << "Render state calls in the last frame: " << LastFrameIssuedCallNum << " issued, "
+      << LastFrameElidedCallNum << " elided (" << getTotalElidedCallNum() << " of " << total_call_num
+      << " elided in total)\n";
+}
\ No newline at end of file
@@ -1,20 +1,81 @@
 #include "Renderer.h"
-
-RendererGL::RendererGL() : 
-   Window( nullptr ), PositionMode( false ), VelocityMode( false ), MoveType( MOVE_TYPE::NONE ),
-   FrameWidth( 1920 ), FrameHeight( 1080 ), FrameIndex( 0 ), PositionCurveSamplePointNum( 101 ),
-   TotalPositionCurvePointNum( 201 ), TotalVelocityCurvePointNum( 201 ),
+#include "Profiler.h"
+
+RendererGL::RendererGL(const Options& options) : 
+   Window( nullptr ), CrosshairCursor( nullptr ), RendererOptions( options ), OffscreenFBO( 0 ),
+   OffscreenColorBuffer( 0 ), OffscreenDepthBuffer( 0 ), LayerFBO( 0 ), LayerTextureIndex( -1 ), PositionMode( false ),
+   VelocityMode( false ),
+   LazySampling( false ), CompactTables( false ), AdaptiveTessellation( false ),
+   MultiViewport( options.MultiViewport ), CachedLayers( options.CachedLayers ),
+   ThickLines( options.ThickLines ), LayerDirty( true ),
+   NeedsRedraw( true ), QueuedInput( false ),
+   MoveType( MOVE_TYPE::NONE ),
+   FrameWidth( 1920 ), FrameHeight( 1080 ), LayerWidth( 1920 ), LayerHeight( 1080 ), FrameIndex( 0 ), TraceDumpNum( 0 ),
+   LayerRedrawNum( 0 ),
+   PositionCurveSamplePointNum( 101 ),
+   TotalPositionCurvePointNum( 201 ), TotalVelocityCurvePointNum( 201 ), TessellationTolerance( 0.25f ),
+   TextureUploadBudget( 2.0 ), ViewportSize( 1920.0f, 1080.0f ), EventCursorPosition( 0.0 ),
+   MovingPoint( 1 ),
    MainCamera( std::make_unique<CameraGL>() ), ObjectShader( std::make_unique<ShaderGL>() ),
+   PanelLineShader( std::make_unique<ShaderGL>() ), PanelPointShader( std::make_unique<ShaderGL>() ),
+   CurveBatchShader( std::make_unique<ShaderGL>() ), ThickLineShader( std::make_unique<ShaderGL>() ),
    AxisObject( std::make_unique<ObjectGL>() ), PositionObject( std::make_unique<ObjectGL>() ),
    VelocityObject( std::make_unique<ObjectGL>() ), PositionCurveObject( std::make_unique<ObjectGL>() ),
-   VelocityCurveObject( std::make_unique<ObjectGL>() ), MovingObject( std::make_unique<ObjectGL>() )
+   VelocityCurveObject( std::make_unique<ObjectGL>() ), MovingObject( std::make_unique<ObjectGL>() ),
+   LayerObject( std::make_unique<ObjectGL>() ),
+   UniformVelocitySampler( std::make_unique<LazySampleProvider>() ),
+   VariableVelocitySampler( std::make_unique<LazySampleProvider>() ), CurveTableCache( std::make_unique<CurveCache>() ),
+   Capturer( std::make_unique<FrameCapturer>() ), PassTimer( std::make_unique<GPUTimer>() ),
+   StateCache( std::make_unique<RenderStateCache>() ), AsyncTextureLoader( std::make_unique<TextureLoader>() ),
+   TexelCache( std::make_unique<TextureCache>() ), Trajectories( std::make_unique<CurveBatch>() ),
+   Pacer( std::make_unique<FramePacer>( options.MaxFramesInFlight ) ), InputEvents( std::make_unique<EventQueue>() ),
+   Recorder( std::make_unique<InputRecorder>() ),
+   MainCurvePass( 0 ), PositionCurvePass( 0 ), VelocityCurvePass( 0 ), PanelPass( 0 ), LayerPass( 0 ),
+   TrajectoryPass( 0 ), InvalidatedTime( std::chrono::steady_clock::now() ),
+   EventThreadID( std::this_thread::get_id() )
 {
-   Renderer = this;
+   AsyncTextureLoader->setDecodedCallback(
+      [this]()
+      {
+         // Whichever thread renders has to wake up to upload the decoded images.
+         glfwPostEmptyEvent();
+         InputEvents->wake();
+      }
+   );
 
    initialize();
    printOpenGLInformation();
 }
 
+RendererGL::~RendererGL()
+{
+   if (Window == nullptr) return;
+
+   // The members below own OpenGL objects, so they have to be destroyed while the context of the window is current,
+   // which may be on another thread than the one that rendered, e.g. after the concurrent benchmark.
+   glfwMakeContextCurrent( Window );
+   destroyLayerTarget();
+   destroyOffscreenTarget();
+   Pacer.reset();
+   Trajectories.reset();
+   PassTimer.reset();
+   Capturer.reset();
+   LayerObject.reset();
+   MovingObject.reset();
+   VelocityCurveObject.reset();
+   PositionCurveObject.reset();
+   VelocityObject.reset();
+   PositionObject.reset();
+   AxisObject.reset();
+   ThickLineShader.reset();
+   CurveBatchShader.reset();
+   PanelPointShader.reset();
+   PanelLineShader.reset();
+   ObjectShader.reset();
+   glfwMakeContextCurrent( nullptr );
+   glfwDestroyWindow( Window );
+}
+
 void RendererGL::printOpenGLInformation()
 {
    std::cout << "****************************************************************\n";
@@ -35,8 +96,17 @@ void RendererGL::initialize()
    glfwWindowHint( GLFW_CONTEXT_VERSION_MINOR, 6 );
    glfwWindowHint( GLFW_DOUBLEBUFFER, GLFW_TRUE );
    glfwWindowHint( GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE );
+   glfwWindowHint( GLFW_CONTEXT_CREATION_API, RendererOptions.ContextCreationAPI );
+   glfwWindowHint( GLFW_VISIBLE, RendererOptions.Headless ? GLFW_FALSE : GLFW_TRUE );
 
+   if (Window != nullptr) glfwDestroyWindow( Window );
    Window = glfwCreateWindow( FrameWidth, FrameHeight, "Main Camera", nullptr, nullptr );
+   if (Window == nullptr) {
+      std::cout << "Cannot create the window...\n";
+      return;
+   }
+   glfwSetWindowUserPointer( Window, this );
+   CrosshairCursor = glfwCreateStandardCursor( GLFW_CROSSHAIR_CURSOR );
    glfwMakeContextCurrent( Window );
 
    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
@@ -45,8 +115,23 @@ void RendererGL::initialize()
    }
    
    registerCallbacks();
+
+   if (RendererOptions.Headless) {
+      glfwSwapInterval( 0 );
+      createOffscreenTarget();
+   }
+   else if (RendererOptions.SwapInterval >= 0) glfwSwapInterval( RendererOptions.SwapInterval );
+
+   PassTimer->destroyQueries();
+   MainCurvePass = PassTimer->addPass( "drawMainCurve" );
+   PositionCurvePass = PassTimer->addPass( "drawPositionCurve" );
+   VelocityCurvePass = PassTimer->addPass( "drawVelocityCurve" );
+   PanelPass = PassTimer->addPass( "drawPanelsInOnePass" );
+   LayerPass = PassTimer->addPass( "drawCachedLayer" );
+   TrajectoryPass = PassTimer->addPass( "drawTrajectories" );
    
    glClearColor( 1.0f, 1.0f, 1.0f, 1.0f );
+   glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 
    MainCamera->updateWindowSize( FrameWidth, FrameHeight );
 
@@ -55,16 +140,103 @@ void RendererGL::initialize()
       std::string(shader_directory_path + "/BasicPipeline.vert").c_str(),
       std::string(shader_directory_path + "/BasicPipeline.frag").c_str()
    );
+   PanelLineShader->setShader(
+      std::string(shader_directory_path + "/MultiViewport.vert").c_str(),
+      std::string(shader_directory_path + "/BasicPipeline.frag").c_str(),
+      std::string(shader_directory_path + "/MultiViewportLines.geom").c_str(),
+      nullptr, nullptr, { "PanelMask" }
+   );
+   PanelPointShader->setShader(
+      std::string(shader_directory_path + "/MultiViewport.vert").c_str(),
+      std::string(shader_directory_path + "/BasicPipeline.frag").c_str(),
+      std::string(shader_directory_path + "/MultiViewportPoints.geom").c_str(),
+      nullptr, nullptr, { "PanelMask" }
+   );
+   CurveBatchShader->setShader(
+      std::string(shader_directory_path + "/CurveBatch.vert").c_str(),
+      std::string(shader_directory_path + "/CurveBatch.frag").c_str()
+   );
+   ThickLineShader->setShader(
+      std::string(shader_directory_path + "/ThickLine.vert").c_str(),
+      std::string(shader_directory_path + "/ThickLine.frag").c_str(),
+      nullptr, nullptr, nullptr, { "LineWidth", "ViewportSize" }
+   );
+}
+
+void RendererGL::createOffscreenTarget()
+{
+   glCreateRenderbuffers( 1, &OffscreenColorBuffer );
+   glNamedRenderbufferStorage( OffscreenColorBuffer, GL_RGBA8, FrameWidth, FrameHeight );
+   glCreateRenderbuffers( 1, &OffscreenDepthBuffer );
+   glNamedRenderbufferStorage( OffscreenDepthBuffer, GL_DEPTH_COMPONENT24, FrameWidth, FrameHeight );
+
+   glCreateFramebuffers( 1, &OffscreenFBO );
+   glNamedFramebufferRenderbuffer( OffscreenFBO, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, OffscreenColorBuffer );
+   glNamedFramebufferRenderbuffer( OffscreenFBO, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, OffscreenDepthBuffer );
+   if (glCheckNamedFramebufferStatus( OffscreenFBO, GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE) {
+      std::cerr << "The offscreen framebuffer is not complete.\n";
+   }
+   glBindFramebuffer( GL_FRAMEBUFFER, OffscreenFBO );
+}
+
+void RendererGL::destroyOffscreenTarget()
+{
+   if (OffscreenFBO == 0) return;
+
+   glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+   glDeleteFramebuffers( 1, &OffscreenFBO );
+   glDeleteRenderbuffers( 1, &OffscreenColorBuffer );
+   glDeleteRenderbuffers( 1, &OffscreenDepthBuffer );
+   OffscreenFBO = OffscreenColorBuffer = OffscreenDepthBuffer = 0;
+}
+
+void RendererGL::createLayerTarget()
+{
+   destroyLayerTarget();
+
+   glCreateFramebuffers( 1, &LayerFBO );
+   glNamedFramebufferTexture( LayerFBO, GL_COLOR_ATTACHMENT0, LayerObject->getTextureID( LayerTextureIndex ), 0 );
+   if (glCheckNamedFramebufferStatus( LayerFBO, GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE) {
+      std::cerr << "The layer framebuffer is not complete.\n";
+   }
+   LayerDirty = true;
+}
+
+void RendererGL::resizeLayerTarget(int width, int height)
+{
+   // A minimized window has no pixels, so the layer keeps its size until the window is restored.
+   if (width <= 0 || height <= 0 || (width == LayerWidth && height == LayerHeight)) return;
+
+   LayerWidth = width;
+   LayerHeight = height;
+   if (LayerTextureIndex < 0) return;
+
+   LayerObject->replaceTexture( LayerTextureIndex, LayerWidth, LayerHeight );
+   createLayerTarget();
+}
+
+void RendererGL::destroyLayerTarget()
+{
+   if (LayerFBO == 0) return;
+
+   glDeleteFramebuffers( 1, &LayerFBO );
+   LayerFBO = 0;
 }
 
-void RendererGL::error(int error, const char* description) const
+RendererGL* RendererGL::getRenderer(GLFWwindow* window)
+{
+   return static_cast<RendererGL*>(glfwGetWindowUserPointer( window ));
+}
+
+void RendererGL::error(int error, const char* description)
 {
    puts( description );
 }
 
 void RendererGL::errorWrapper(int error, const char* description)
 {
-   Renderer->error( error, description );
+   // The error callback is global, so it does not belong to any renderer.
+   RendererGL::error( error, description );
 }
 
 void RendererGL::cleanup(GLFWwindow* window)
@@ -74,34 +246,109 @@ void RendererGL::cleanup(GLFWwindow* window)
 
 void RendererGL::cleanupWrapper(GLFWwindow* window)
 {
-   Renderer->cleanup( window );
+   getRenderer( window )->cleanup( window );
 }
 
 void RendererGL::clearCurve()
 {
    MoveType = MOVE_TYPE::NONE;
    
-   double x_pos, y_pos;
-   glfwGetCursorPos( Window, &x_pos, &y_pos );
-   const auto x = static_cast<float>(x_pos);
-   const auto y = static_cast<float>(y_pos);
+   const auto x = static_cast<float>(EventCursorPosition.x);
+   const auto y = static_cast<float>(EventCursorPosition.y);
    
    if (1280.0f <= x && y <= 540.0f) {
+      // Both samplers read the position control points on their own threads.
+      UniformVelocitySampler->stop();
+      VariableVelocitySampler->stop();
       PositionMode = false;
       PositionControlPoints.clear();
       PositionCurve.clear();
       UniformVelocityCurve.clear();
+      CompactPositionCurve.clear();
+      CompactUniformVelocityCurve.clear();
       std::cout << "Clear the position curve.\n";
    }
    else if (1280.0f <= x && 540.0f < y) {
+      VariableVelocitySampler->stop();
       VelocityMode = false;
       VelocityControlPoints.clear();
       VelocityCurve.clear();
       VariableVelocityCurve.clear();
+      CompactVelocityCurve.clear();
+      CompactVariableVelocityCurve.clear();
       std::cout << "Clear the velocity curve.\n";
    }
 }
 
+void RendererGL::receiveEvent(EventQueue::Event& event)
+{
+   glfwGetCursorPos( Window, &event.CursorX, &event.CursorY );
+   event.Time = std::chrono::steady_clock::now();
+   Recorder->record( event );
+   if (!QueuedInput) {
+      dispatchEvent( event );
+      return;
+   }
+
+   // The render thread drains the queue every frame, so a full queue is only waited for a frame.
+   while (!InputEvents->push( event )) std::this_thread::yield();
+}
+
+void RendererGL::dispatchEvent(const EventQueue::Event& event)
+{
+   const bool invalidated = NeedsRedraw;
+   EventCursorPosition = glm::dvec2( event.CursorX, event.CursorY );
+   switch (event.Type) {
+      case EventQueue::TYPE::KEY:
+         keyboard( Window, event.Key, event.Scancode, event.Action, event.Mods );
+         break;
+      case EventQueue::TYPE::MOUSE_BUTTON:
+         mouse( Window, event.Key, event.Action, event.Mods );
+         break;
+      case EventQueue::TYPE::FRAMEBUFFER_SIZE:
+         reshape( Window, event.Width, event.Height );
+         break;
+      case EventQueue::TYPE::REFRESH:
+      default:
+         refresh( Window );
+         break;
+   }
+
+   // The latency starts when the event thread received the event, not when it was dispatched.
+   if (!invalidated && NeedsRedraw) InvalidatedTime = event.Time;
+}
+
+void RendererGL::dispatchEvents()
+{
+   PROFILE_ZONE( "RendererGL::dispatchEvents" );
+
+   EventQueue::Event event;
+   while (InputEvents->pop( event )) {
+      const std::chrono::duration<double, std::milli> delay = std::chrono::steady_clock::now() - event.Time;
+      Redraws.TotalQueueDelayMilliseconds += delay.count();
+      Redraws.MaxQueueDelayMilliseconds = std::max( Redraws.MaxQueueDelayMilliseconds, delay.count() );
+      Redraws.QueuedEventNum++;
+      dispatchEvent( event );
+   }
+}
+
+void RendererGL::replayEvents()
+{
+   EventQueue::Event event;
+   bool idle = isIdle();
+   while (Recorder->getDueEvent( event, idle )) {
+      dispatchEvent( event );
+      idle = isIdle();
+   }
+
+   // The replay ends after the last event and the motion it started, so the statistics cover the whole scene.
+   if (Recorder->hasReplayFinished() && idle) {
+      Recorder->finishReplaying();
+      glfwSetWindowShouldClose( Window, GLFW_TRUE );
+      glfwPostEmptyEvent();
+   }
+}
+
 void RendererGL::keyboard(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
    if (action != GLFW_PRESS) return;
@@ -113,7 +360,7 @@ void RendererGL::keyboard(GLFWwindow* window, int key, int scancode, int action,
          std::cout << "Select 4 points for the position curve.\n";
          break;
       case GLFW_KEY_V:
-         if (static_cast<int>(PositionCurve.size()) != PositionCurveSamplePointNum) {
+         if (getPositionCurveSampleNum() == 0) {
             std::cout << "Select Position Curve Points First!\n";
             return;
          }
@@ -124,17 +371,42 @@ void RendererGL::keyboard(GLFWwindow* window, int key, int scancode, int action,
       case GLFW_KEY_C:
          clearCurve();
          break;
+      case GLFW_KEY_L:
+         LazySampling = !LazySampling;
+         std::cout << "Lazy sampling is " << (LazySampling ? "enabled" : "disabled") << " for the next curves.\n";
+         break;
+      case GLFW_KEY_Z:
+         CompactTables = !CompactTables;
+         std::cout << "Compact tables are " << (CompactTables ? "enabled" : "disabled") << " for the next curves.\n";
+         break;
+      case GLFW_KEY_A:
+         AdaptiveTessellation = !AdaptiveTessellation;
+         std::cout << "Adaptive tessellation is " << (AdaptiveTessellation ? "enabled" : "disabled") << " for the next curves.\n";
+         break;
+      case GLFW_KEY_S:
+         CachedLayers = !CachedLayers;
+         std::cout << "The static contents of the panels are " << (CachedLayers ? "cached in a texture" : "redrawn every frame") << ".\n";
+         break;
+      case GLFW_KEY_M:
+         MultiViewport = !MultiViewport;
+         std::cout << "The panels are rendered in " << (MultiViewport ? "one pass" : "three passes") << ".\n";
+         break;
+      case GLFW_KEY_W:
+         ThickLines = !ThickLines;
+         std::cout << "The lines are drawn " << (ThickLines ? "as anti-aliased quads" : "with glLineWidth") << ".\n";
+         break;
+      case GLFW_KEY_T:
+         dumpTrace();
+         break;
       case GLFW_KEY_1:
-         if (static_cast<int>(PositionCurve.size()) == PositionCurveSamplePointNum &&
-             static_cast<int>(UniformVelocityCurve.size()) == TotalPositionCurvePointNum) {
+         if (isUniformMotionReady()) {
             std::cout << "The point is moving at an uniform speed.\n";
             MoveType = MOVE_TYPE::UNIFORM;
             FrameIndex = 0;
          }
          break;
       case GLFW_KEY_2:
-         if (static_cast<int>(VelocityCurve.size()) == TotalVelocityCurvePointNum &&
-             static_cast<int>(VariableVelocityCurve.size()) == TotalVelocityCurvePointNum) {
+         if (isVariableMotionReady()) {
             std::cout << "The point is moving at an variable speed.\n";
             MoveType = MOVE_TYPE::VARIABLE;
             FrameIndex = 0;
@@ -147,24 +419,32 @@ void RendererGL::keyboard(GLFWwindow* window, int key, int scancode, int action,
       default:
          return;
    }
+   invalidate();
 }
 
 void RendererGL::keyboardWrapper(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-   Renderer->keyboard( window, key, scancode, action, mods );
+   EventQueue::Event event;
+   event.Type = EventQueue::TYPE::KEY;
+   event.Key = key;
+   event.Scancode = scancode;
+   event.Action = action;
+   event.Mods = mods;
+   getRenderer( window )->receiveEvent( event );
 }
 
 void RendererGL::cursor(GLFWwindow* window, double xpos, double ypos)
 {
    if (1280.0f <= static_cast<float>(xpos)) {
-      glfwSetCursor( window, glfwCreateStandardCursor( GLFW_CROSSHAIR_CURSOR ) );
+      glfwSetCursor( window, CrosshairCursor );
    }
    else glfwSetCursor( window, nullptr );
 }
 
 void RendererGL::cursorWrapper(GLFWwindow* window, double xpos, double ypos)
 {
-   Renderer->cursor( window, xpos, ypos );
+   // It only changes the cursor, which has to be done on the event thread anyway, so it is never queued.
+   getRenderer( window )->cursor( window, xpos, ypos );
 }
 
 void RendererGL::getPointOnPositionBezierCurve(glm::vec3& point, float t)
@@ -215,6 +495,8 @@ float RendererGL::getCurveLengthFromZeroTo(float t)
 
 float RendererGL::getInverseCurveLength(float length) 
 {
+   PROFILE_ZONE( "RendererGL::getInverseCurveLength" );
+
    const float epsilon = 0.00001f;
    float a = 0.0f, b = 1.0f;
    float mid;
@@ -230,20 +512,114 @@ float RendererGL::getInverseCurveLength(float length)
    return (a + b) / 2;
 }
 
+float RendererGL::getChordErrorInPixels(const glm::vec3& p0, const glm::vec3& p, const glm::vec3& p1) const
+{
+   // The main viewport is the largest one that shows the position curve.
+   const glm::vec2 to_pixel(
+      1280.0f / static_cast<float>(FrameWidth),
+      1080.0f / static_cast<float>(FrameHeight)
+   );
+   const glm::vec2 a = to_pixel * glm::vec2(p0);
+   const glm::vec2 b = to_pixel * glm::vec2(p1);
+   const glm::vec2 c = to_pixel * glm::vec2(p);
+   const glm::vec2 chord = b - a;
+   const float squared_length = dot( chord, chord );
+   if (squared_length == 0.0f) return distance( a, c );
+
+   const float s = std::clamp( dot( c - a, chord ) / squared_length, 0.0f, 1.0f );
+   return distance( a + s * chord, c );
+}
+
+void RendererGL::subdividePositionCurve(float t0, const glm::vec3& p0, float t1, const glm::vec3& p1, int depth)
+{
+   // A few uniform subdivisions first, so that a symmetric S-shaped segment is not mistaken for a flat one.
+   constexpr int min_depth = 2;
+   constexpr int max_depth = 16;
+
+   const float t = (t0 + t1) * 0.5f;
+   glm::vec3 p;
+   getPointOnPositionBezierCurve( p, t );
+   if (depth >= max_depth ||
+       (depth >= min_depth && getChordErrorInPixels( p0, p, p1 ) <= TessellationTolerance)) {
+      PositionCurve.emplace_back( p1 );
+      return;
+   }
+   subdividePositionCurve( t0, p0, t, p, depth + 1 );
+   subdividePositionCurve( t, p, t1, p1, depth + 1 );
+}
+
+void RendererGL::tessellatePositionCurve()
+{
+   const auto start = std::chrono::steady_clock::now();
+
+   glm::vec3 first, last;
+   getPointOnPositionBezierCurve( first, 0.0f );
+   getPointOnPositionBezierCurve( last, 1.0f );
+   PositionCurve.emplace_back( first );
+   subdividePositionCurve( 0.0f, first, 1.0f, last, 0 );
+
+   const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+   std::cout << "Tessellated the position curve into " << PositionCurve.size() << " vertices within "
+      << TessellationTolerance << " pixels in " << elapsed.count() << " ms.\n";
+}
+
 void RendererGL::createPositionCurve()
 {
+   PROFILE_ZONE( "RendererGL::createPositionCurve" );
+
+   CurveCache::Key key(
+      PositionControlPoints, {},
+      { PositionCurveSamplePointNum, TotalPositionCurvePointNum, AdaptiveTessellation ? 1 : 0, CompactTables ? 1 : 0 }
+   );
+   if (const CurveCache::Tables* cached = CurveTableCache->find( key )) {
+      if (CompactTables) {
+         CompactPositionCurve = cached->CompactCurve;
+         CompactUniformVelocityCurve = cached->CompactMotion;
+         PositionCurveObject->updateDataBuffer(
+            CompactPositionCurve.getData(),
+            CompactPositionCurve.getOffset(),
+            CompactPositionCurve.getExtent()
+         );
+      }
+      else {
+         PositionCurve = cached->Curve;
+         UniformVelocityCurve = cached->Motion;
+         PositionCurveObject->updateDataBuffer( PositionCurve );
+      }
+      printCurveCacheStatistics( "position" );
+      return;
+   }
+
    float t = 0.0f;
-   const float dt = 1.0f / static_cast<float>(PositionCurveSamplePointNum - 1);
-   for (int i = 0; i < PositionCurveSamplePointNum; ++i) {
-      glm::vec3 position;
-      getPointOnPositionBezierCurve( position, t );
-      PositionCurve.emplace_back( position );
-      t += dt;
+   if (AdaptiveTessellation) tessellatePositionCurve();
+   else {
+      PositionCurve.reserve( PositionCurveSamplePointNum );
+      const float dt = 1.0f / static_cast<float>(PositionCurveSamplePointNum - 1);
+      for (int i = 0; i < PositionCurveSamplePointNum; ++i) {
+         glm::vec3 position;
+         getPointOnPositionBezierCurve( position, t );
+         PositionCurve.emplace_back( position );
+         t += dt;
+      }
    }
    PositionCurveObject->updateDataBuffer( PositionCurve );
 
    float l = 0.0f;
    const float dl = getCurveLengthFromZeroTo( 1.0f ) / static_cast<float>(TotalPositionCurvePointNum - 1);
+   if (LazySampling) {
+      UniformVelocitySampler->start(
+         TotalPositionCurvePointNum,
+         [this, dl](int index)
+         {
+            glm::vec3 uniform;
+            getPointOnPositionBezierCurve( uniform, getInverseCurveLength( static_cast<float>(index) * dl ) );
+            return uniform;
+         }
+      );
+      return;
+   }
+
+   UniformVelocityCurve.reserve( TotalPositionCurvePointNum );
    for (int i = 0; i < TotalPositionCurvePointNum; ++i) {
       glm::vec3 uniform;
       t = getInverseCurveLength( l );
@@ -251,6 +627,12 @@ void RendererGL::createPositionCurve()
       UniformVelocityCurve.emplace_back( uniform );
       l += dl;
    }
+   compactPositionCurve();
+   if (CompactTables) {
+      CurveTableCache->insert( std::move( key ), { {}, {}, CompactPositionCurve, CompactUniformVelocityCurve } );
+   }
+   else CurveTableCache->insert( std::move( key ), { PositionCurve, UniformVelocityCurve, {}, {} } );
+   printCurveCacheStatistics( "position" );
 }
 
 glm::vec3 RendererGL::getPointOnVelocityBezierCurve(float t)
@@ -266,8 +648,33 @@ glm::vec3 RendererGL::getPointOnVelocityBezierCurve(float t)
 
 void RendererGL::createVelocityCurve()
 {
+   PROFILE_ZONE( "RendererGL::createVelocityCurve" );
+
+   CurveCache::Key key(
+      PositionControlPoints, VelocityControlPoints, { TotalVelocityCurvePointNum, CompactTables ? 1 : 0 }
+   );
+   if (const CurveCache::Tables* cached = CurveTableCache->find( key )) {
+      if (CompactTables) {
+         CompactVelocityCurve = cached->CompactCurve;
+         CompactVariableVelocityCurve = cached->CompactMotion;
+         VelocityCurveObject->updateDataBuffer(
+            CompactVelocityCurve.getData(),
+            CompactVelocityCurve.getOffset(),
+            CompactVelocityCurve.getExtent()
+         );
+      }
+      else {
+         VelocityCurve = cached->Curve;
+         VariableVelocityCurve = cached->Motion;
+         VelocityCurveObject->updateDataBuffer( VelocityCurve );
+      }
+      printCurveCacheStatistics( "velocity" );
+      return;
+   }
+
    float t = 0.0f; 
    const float dt = 1.0f / static_cast<float>(TotalVelocityCurvePointNum - 1); 
+   VelocityCurve.reserve( TotalVelocityCurvePointNum );
    for (int i = 0; i < TotalVelocityCurvePointNum; ++i) {
       VelocityCurve.emplace_back( getPointOnVelocityBezierCurve( t ) );
       t += dt; 
@@ -275,20 +682,128 @@ void RendererGL::createVelocityCurve()
    VelocityCurveObject->updateDataBuffer( VelocityCurve );
 
    const float to_length = getCurveLengthFromZeroTo( 1.0f ) / (VelocityControlPoints[3].y - VelocityControlPoints[0].y);
+   if (LazySampling) {
+      VariableVelocitySampler->start(
+         TotalVelocityCurvePointNum,
+         [this, dt, to_length](int index)
+         {
+            const float y = getPointOnVelocityBezierCurve( static_cast<float>(index) * dt ).y;
+            glm::vec3 variable;
+            getPointOnPositionBezierCurve( variable, getInverseCurveLength( y * to_length ) );
+            return variable;
+         }
+      );
+      return;
+   }
+
+   VariableVelocityCurve.reserve( TotalVelocityCurvePointNum );
    for (int i = 0; i < TotalVelocityCurvePointNum; ++i) {
       glm::vec3 variable;
       getPointOnPositionBezierCurve( variable, getInverseCurveLength( VelocityCurve[i].y * to_length ) );
       VariableVelocityCurve.emplace_back( variable );
    }
+   compactVelocityCurve();
+   if (CompactTables) {
+      CurveTableCache->insert( std::move( key ), { {}, {}, CompactVelocityCurve, CompactVariableVelocityCurve } );
+   }
+   else CurveTableCache->insert( std::move( key ), { VelocityCurve, VariableVelocityCurve, {}, {} } );
+   printCurveCacheStatistics( "velocity" );
+}
+
+void RendererGL::printCurveCacheStatistics(const char* curve_name) const
+{
+   std::cout << "Curve cache after creating the " << curve_name << " curve: "
+      << CurveTableCache->getHitNum() << " hits, " << CurveTableCache->getMissNum() << " misses, "
+      << CurveTableCache->getEvictionNum() << " evictions, " << CurveTableCache->getEntryNum() << " entries ("
+      << CurveTableCache->getMemoryUsage() << "/" << CurveTableCache->getMemoryBudget() << " bytes)\n";
+}
+
+void RendererGL::compactCurveTable(
+   CompactCurveTable& compact_table,
+   std::vector<glm::vec3>& table,
+   const char* table_name
+)
+{
+   if (table.empty()) return;
+
+   const size_t original_size = sizeof( glm::vec3 ) * table.size();
+   compact_table.encode( table );
+   table.clear();
+   table.shrink_to_fit();
+   std::cout << "Compact " << table_name << " table: " << compact_table.size() << " samples, "
+      << original_size << " -> " << compact_table.getMemorySize() << " bytes, max error "
+      << compact_table.getErrorBound() << "\n";
+}
+
+void RendererGL::compactPositionCurve()
+{
+   if (!CompactTables) return;
+
+   compactCurveTable( CompactPositionCurve, PositionCurve, "position curve" );
+   compactCurveTable( CompactUniformVelocityCurve, UniformVelocityCurve, "uniform velocity" );
+   PositionCurveObject->updateDataBuffer(
+      CompactPositionCurve.getData(),
+      CompactPositionCurve.getOffset(),
+      CompactPositionCurve.getExtent()
+   );
+}
+
+void RendererGL::compactVelocityCurve()
+{
+   if (!CompactTables) return;
+
+   compactCurveTable( CompactVelocityCurve, VelocityCurve, "velocity curve" );
+   compactCurveTable( CompactVariableVelocityCurve, VariableVelocityCurve, "variable velocity" );
+   VelocityCurveObject->updateDataBuffer(
+      CompactVelocityCurve.getData(),
+      CompactVelocityCurve.getOffset(),
+      CompactVelocityCurve.getExtent()
+   );
+}
+
+int RendererGL::getPositionCurveSampleNum() const
+{
+   return PositionCurve.empty() ? CompactPositionCurve.size() : static_cast<int>(PositionCurve.size());
+}
+
+int RendererGL::getVelocityCurveSampleNum() const
+{
+   return VelocityCurve.empty() ? CompactVelocityCurve.size() : static_cast<int>(VelocityCurve.size());
+}
+
+glm::vec3 RendererGL::getUniformMotionPoint(int index) const
+{
+   if (UniformVelocitySampler->isRunning()) return UniformVelocitySampler->getSample( index );
+   return UniformVelocityCurve.empty() ? CompactUniformVelocityCurve.getSample( index ) : UniformVelocityCurve[index];
+}
+
+glm::vec3 RendererGL::getVariableMotionPoint(int index) const
+{
+   if (VariableVelocitySampler->isRunning()) return VariableVelocitySampler->getSample( index );
+   return VariableVelocityCurve.empty() ? CompactVariableVelocityCurve.getSample( index ) : VariableVelocityCurve[index];
+}
+
+bool RendererGL::isUniformMotionReady() const
+{
+   if (getPositionCurveSampleNum() == 0) return false;
+   return UniformVelocitySampler->isRunning() ||
+      static_cast<int>(UniformVelocityCurve.size()) == TotalPositionCurvePointNum ||
+      CompactUniformVelocityCurve.size() == TotalPositionCurvePointNum;
+}
+
+bool RendererGL::isVariableMotionReady() const
+{
+   if (getVelocityCurveSampleNum() != TotalVelocityCurvePointNum) return false;
+   return VariableVelocitySampler->isRunning() ||
+      static_cast<int>(VariableVelocityCurve.size()) == TotalVelocityCurvePointNum ||
+      CompactVariableVelocityCurve.size() == TotalVelocityCurvePointNum;
 }
 
 void RendererGL::mouse(GLFWwindow* window, int button, int action, int mods)
 {
    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
-      double x_pos, y_pos;
-      glfwGetCursorPos( window, &x_pos, &y_pos );
-      const auto x = static_cast<float>(x_pos);
-      const auto y = static_cast<float>(y_pos);
+      const auto x = static_cast<float>(EventCursorPosition.x);
+      const auto y = static_cast<float>(EventCursorPosition.y);
       
       if (PositionMode && PositionControlPoints.size() <= 3 && 1280.0f <= x && y <= 540.0f) {
          PositionControlPoints.emplace_back( (x - 1280.0f) * 3.0f, (540.0f - y) * 2.0f, 0.0f );
@@ -310,23 +825,51 @@ void RendererGL::mouse(GLFWwindow* window, int button, int action, int mods)
             createVelocityCurve();
          }
       }
+      else return;
+
+      // The new control point or the rebuilt curve has to be shown.
+      invalidate();
    }
 }
 
 void RendererGL::mouseWrapper(GLFWwindow* window, int button, int action, int mods)
 {
-   Renderer->mouse( window, button, action, mods );
+   EventQueue::Event event;
+   event.Type = EventQueue::TYPE::MOUSE_BUTTON;
+   event.Key = button;
+   event.Action = action;
+   event.Mods = mods;
+   getRenderer( window )->receiveEvent( event );
 }
 
-void RendererGL::reshape(GLFWwindow* window, int width, int height) const
+void RendererGL::reshape(GLFWwindow* window, int width, int height)
 {
    MainCamera->updateWindowSize( width, height );
-   glViewport( 0, 0, width, height );
+   setViewport( 0, 0, width, height );
+   resizeLayerTarget( width, height );
+   invalidate();
 }
 
 void RendererGL::reshapeWrapper(GLFWwindow* window, int width, int height)
 {
-   Renderer->reshape( window, width, height );
+   EventQueue::Event event;
+   event.Type = EventQueue::TYPE::FRAMEBUFFER_SIZE;
+   event.Width = width;
+   event.Height = height;
+   getRenderer( window )->receiveEvent( event );
+}
+
+void RendererGL::refresh(GLFWwindow* window)
+{
+   // The window system lost the contents, e.g. the window was uncovered.
+   invalidate();
+}
+
+void RendererGL::refreshWrapper(GLFWwindow* window)
+{
+   EventQueue::Event event;
+   event.Type = EventQueue::TYPE::REFRESH;
+   getRenderer( window )->receiveEvent( event );
 }
 
 void RendererGL::registerCallbacks() const
@@ -337,6 +880,7 @@ void RendererGL::registerCallbacks() const
    glfwSetCursorPosCallback( Window, cursorWrapper );
    glfwSetMouseButtonCallback( Window, mouseWrapper );
    glfwSetFramebufferSizeCallback( Window, reshapeWrapper );
+   glfwSetWindowRefreshCallback( Window, refreshWrapper );
 }
 
 void RendererGL::setAxisObject() const
@@ -357,9 +901,11 @@ void RendererGL::setCurveObjects() const
    VelocityObject->setObject( GL_LINE_STRIP, 4 );
    VelocityObject->setDiffuseReflectionColor( { 0.9f, 0.8f, 0.1f, 1.0f } );
 
+   PositionCurveObject->setVertexFormat( RendererOptions.CurveVertexFormat );
    PositionCurveObject->setObject( GL_LINE_STRIP, PositionCurveSamplePointNum );
    PositionCurveObject->setDiffuseReflectionColor( { 0.9f, 0.1f, 0.1f, 1.0f } );
 
+   VelocityCurveObject->setVertexFormat( RendererOptions.CurveVertexFormat );
    VelocityCurveObject->setObject( GL_LINE_STRIP, TotalVelocityCurvePointNum );
    VelocityCurveObject->setDiffuseReflectionColor( { 0.9f, 0.1f, 0.1f, 1.0f } );
 
@@ -367,105 +913,241 @@ void RendererGL::setCurveObjects() const
    MovingObject->setDiffuseReflectionColor( { 1.0f, 0.0f, 0.0f, 1.0f } );
 }
 
-void RendererGL::drawAxisObject() const
+void RendererGL::setLayerObject()
+{
+   // The layer covers the whole frame, so it is drawn at the frame size through the main camera.
+   LayerObject->setSquareObject( GL_TRIANGLES );
+   LayerObject->setDiffuseReflectionColor( { 1.0f, 1.0f, 1.0f, 1.0f } );
+   if (LayerTextureIndex < 0) {
+      LayerTextureIndex = LayerObject->getTextureNum();
+      LayerObject->addTexture( LayerWidth, LayerHeight );
+   }
+   createLayerTarget();
+}
+
+void RendererGL::setObjects()
+{
+   setAxisObject();
+   setCurveObjects();
+   setLayerObject();
+   setTrajectories();
+   ObjectShader->setUniformLocations( 0 );
+   PanelLineShader->setUniformLocations( 0 );
+   PanelPointShader->setUniformLocations( 0 );
+   CurveBatchShader->setUniformLocations( 0 );
+   ThickLineShader->setUniformLocations( 0 );
+   PanelLineMask = PanelLineShader->addUniformLocation( "PanelMask" );
+   PanelPointMask = PanelPointShader->addUniformLocation( "PanelMask" );
+   ThickLineWidth = ThickLineShader->addUniformLocation( "LineWidth" );
+   ThickLineViewportSize = ThickLineShader->addUniformLocation( "ViewportSize" );
+}
+
+void RendererGL::setTrajectories()
+{
+   Trajectories->clear();
+   if (RendererOptions.TrajectoryNum <= 0) return;
+
+   // The trajectories are random cubic Bezier curves within the axes of the main panel. The seed is fixed, so every
+   // run draws the same scene.
+   std::mt19937 generator( 2021 );
+   std::uniform_real_distribution<float> x_distribution( 150.0f, 1750.0f );
+   std::uniform_real_distribution<float> y_distribution( 100.0f, 900.0f );
+   std::uniform_real_distribution<float> color_distribution( 0.2f, 0.9f );
+   constexpr int sample_num = 64;
+   std::vector<glm::vec3> vertices( sample_num );
+   for (int i = 0; i < RendererOptions.TrajectoryNum; ++i) {
+      glm::vec3 control_points[4];
+      for (auto& point : control_points) {
+         point = glm::vec3(x_distribution( generator ), y_distribution( generator ), 0.0f);
+      }
+      for (int j = 0; j < sample_num; ++j) {
+         const float t = static_cast<float>(j) / static_cast<float>(sample_num - 1);
+         const float one_minus_t = 1.0f - t;
+         vertices[j] = one_minus_t * one_minus_t * one_minus_t * control_points[0] +
+            3.0f * one_minus_t * one_minus_t * t * control_points[1] +
+            3.0f * one_minus_t * t * t * control_points[2] +
+            t * t * t * control_points[3];
+      }
+      const glm::vec4 color(
+         color_distribution( generator ), color_distribution( generator ), color_distribution( generator ), 1.0f
+      );
+      Trajectories->addCurve( vertices, color );
+   }
+   Trajectories->upload();
+   // The upload may have replaced the buffers, and a new buffer can get the name of a deleted one.
+   StateCache->invalidate();
+   std::cout << "Batched " << Trajectories->getCurveNum() << " trajectories into " << Trajectories->getVertexNum()
+      << " vertices and " << Trajectories->getIndexNum() << " indices, drawn with one call.\n";
+}
+
+void RendererGL::setBenchmarkCurves()
+{
+   PositionControlPoints = {
+      { 300.0f, 200.0f, 0.0f },
+      { 600.0f, 900.0f, 0.0f },
+      { 1300.0f, 100.0f, 0.0f },
+      { 1700.0f, 800.0f, 0.0f }
+   };
+   createPositionCurve();
+
+   VelocityControlPoints = {
+      { 150.0f, 100.0f, 0.0f },
+      { 700.0f, 900.0f, 0.0f },
+      { 1200.0f, 100.0f, 0.0f },
+      { 1750.0f, 900.0f, 0.0f }
+   };
+   createVelocityCurve();
+}
+
+void RendererGL::setViewport(int x, int y, int width, int height)
+{
+   glViewport( x, y, width, height );
+   ViewportSize = glm::vec2(static_cast<float>(width), static_cast<float>(height));
+}
+
+void RendererGL::drawLines(ObjectGL* object, const glm::mat4& to_world, float width)
+{
+   if (ThickLines) {
+      drawThickLines( object, to_world, width );
+      return;
+   }
+
+   StateCache->useProgram( ObjectShader->getShaderProgram() );
+   StateCache->setBlending( false );
+   StateCache->setLineWidth( width );
+   ObjectShader->transferBasicTransformationUniforms( to_world, MainCamera.get() );
+   object->transferUniformsToShader( ObjectShader.get() );
+   StateCache->bindVertexArray( object->getVAO() );
+   glDrawArrays( object->getDrawMode(), 0, object->getVertexNum() );
+}
+
+void RendererGL::drawThickLines(ObjectGL* object, const glm::mat4& to_world, float width)
+{
+   // Every segment is an instance of a quad, which the vertex shader expands around the segment in pixels,
+   // so the width does not depend on the line widths which the implementation supports.
+   StateCache->useProgram( ThickLineShader->getShaderProgram() );
+   StateCache->setBlending( true );
+   glUniform1f( ThickLineShader->getLocation( ThickLineWidth ), width );
+   glUniform2fv( ThickLineShader->getLocation( ThickLineViewportSize ), 1, &ViewportSize[0] );
+   ThickLineShader->transferBasicTransformationUniforms( to_world, MainCamera.get() );
+   object->transferUniformsToShader( ThickLineShader.get() );
+   StateCache->bindVertexArray( object->getSegmentVAO() );
+   glDrawArraysInstanced( GL_TRIANGLE_STRIP, 0, 4, object->getSegmentNum() );
+}
+
+void RendererGL::drawAxisObject()
 {   
-   glUseProgram( ObjectShader->getShaderProgram() );
-   glLineWidth( 5.0f );
+   PROFILE_ZONE( "RendererGL::drawAxisObject" );
 
    const glm::mat4 scale_matrix = scale( glm::mat4(1.0f), glm::vec3(1600.0f, 800.0f, 1.0f) );
    const glm::mat4 translation = translate( glm::mat4(1.0f), glm::vec3(150.0f, 100.0f, 0.0f) );
-   glm::mat4 to_world = translation * scale_matrix;
-   ObjectShader->transferBasicTransformationUniforms( to_world, MainCamera.get() );
-   AxisObject->transferUniformsToShader( ObjectShader.get() );
-   
-   glBindVertexArray( AxisObject->getVAO() );
-   glDrawArrays( AxisObject->getDrawMode(), 0, AxisObject->getVertexNum() );
+   const glm::mat4 to_world = translation * scale_matrix;
+   drawLines( AxisObject.get(), to_world, 5.0f );
 
    const glm::mat4 rotation = glm::rotate( glm::mat4(1.0f), glm::radians( 90.0f ), glm::vec3(0.0f, 0.0f, 1.0f) );
-   to_world = to_world * rotation;
-   ObjectShader->transferBasicTransformationUniforms( to_world, MainCamera.get() );
-   AxisObject->transferUniformsToShader( ObjectShader.get() );
-
-   glDrawArrays( AxisObject->getDrawMode(), 0, AxisObject->getVertexNum() );
-   glLineWidth( 1.0f );
+   drawLines( AxisObject.get(), to_world * rotation, 5.0f );
 }
 
-void RendererGL::drawControlPoints(ObjectGL* control_points) const
+void RendererGL::drawControlPoints(ObjectGL* control_points)
 { 
-   glUseProgram( ObjectShader->getShaderProgram() );
-   glLineWidth( 3.0f );
-   glPointSize( 10.0f );
+   PROFILE_ZONE( "RendererGL::drawControlPoints" );
+
+   drawLines( control_points, glm::mat4(1.0f), 3.0f );
 
+   StateCache->useProgram( ObjectShader->getShaderProgram() );
+   StateCache->setBlending( false );
+   StateCache->setPointSize( 10.0f );
    ObjectShader->transferBasicTransformationUniforms( glm::mat4(1.0f), MainCamera.get() );
    control_points->transferUniformsToShader( ObjectShader.get() );
-
-   glBindVertexArray( control_points->getVAO() );
-   glDrawArrays( control_points->getDrawMode(), 0, control_points->getVertexNum() );
+   StateCache->bindVertexArray( control_points->getVAO() );
    glDrawArrays( GL_POINTS, 0, control_points->getVertexNum() );
-   glLineWidth( 1.0f );
-   glPointSize( 1.0f );
 }
 
-void RendererGL::drawCurve(ObjectGL* curve) const
+void RendererGL::drawCurve(ObjectGL* curve)
 {
-   glUseProgram( ObjectShader->getShaderProgram() );
-   glLineWidth( 3.0f );
-
-   ObjectShader->transferBasicTransformationUniforms( glm::mat4(1.0f), MainCamera.get() );
-   curve->transferUniformsToShader( ObjectShader.get() );
+   PROFILE_ZONE( "RendererGL::drawCurve" );
 
-   glBindVertexArray( curve->getVAO() );
-   glDrawArrays( curve->getDrawMode(), 0, curve->getVertexNum() );
-   glLineWidth( 1.0f );
+   drawLines( curve, glm::mat4(1.0f), 3.0f );
 }
 
-void RendererGL::drawMovingPoint()
+bool RendererGL::updateMovingPoint()
 {
    switch(MoveType) {
       case MOVE_TYPE::UNIFORM:
          if (FrameIndex >= TotalPositionCurvePointNum) FrameIndex = TotalPositionCurvePointNum - 1;
-         MovingObject->updateDataBuffer( { UniformVelocityCurve[FrameIndex] } );
+         MovingPoint[0] = getUniformMotionPoint( FrameIndex );
          break;
       case MOVE_TYPE::VARIABLE:
          if (FrameIndex >= TotalVelocityCurvePointNum) FrameIndex = TotalVelocityCurvePointNum - 1;
-         MovingObject->updateDataBuffer( { VariableVelocityCurve[FrameIndex] } );
+         MovingPoint[0] = getVariableMotionPoint( FrameIndex );
          break;
       case MOVE_TYPE::NONE:
       default:
-         return;
+         return false;
    }
+   MovingObject->updateDataBuffer( MovingPoint );
+   FrameIndex++;
+   return true;
+}
 
-   glUseProgram( ObjectShader->getShaderProgram() );
-   glPointSize( 20.0f );
+void RendererGL::drawMovingPoint()
+{
+   PROFILE_ZONE( "RendererGL::drawMovingPoint" );
+
+   if (!updateMovingPoint()) return;
+
+   StateCache->useProgram( ObjectShader->getShaderProgram() );
+   StateCache->setBlending( false );
+   StateCache->setPointSize( 20.0f );
 
    ObjectShader->transferBasicTransformationUniforms( glm::mat4(1.0f), MainCamera.get() );
    MovingObject->transferUniformsToShader( ObjectShader.get() );
 
-   glBindVertexArray( MovingObject->getVAO() );
+   StateCache->bindVertexArray( MovingObject->getVAO() );
    glDrawArrays( MovingObject->getDrawMode(), 0, MovingObject->getVertexNum() );
-   glPointSize( 1.0f );
+}
 
-   FrameIndex++;
+void RendererGL::drawTrajectories()
+{
+   PROFILE_ZONE( "RendererGL::drawTrajectories" );
+
+   if (Trajectories->getCurveNum() == 0) return;
+
+   GPUTimer::Scope scope( *PassTimer, TrajectoryPass );
+   StateCache->useProgram( CurveBatchShader->getShaderProgram() );
+   StateCache->setBlending( false );
+   StateCache->setLineWidth( 1.0f );
+   CurveBatchShader->transferBasicTransformationUniforms( glm::mat4(1.0f), MainCamera.get() );
+   StateCache->bindVertexArray( Trajectories->getVAO() );
+   StateCache->bindShaderStorageBuffer( Trajectories->getColorBindingIndex(), Trajectories->getColorBuffer() );
+   // Only this draw is indexed, so the restart is left enabled for the next frame.
+   StateCache->setPrimitiveRestart( true );
+   Trajectories->draw();
 }
 
-void RendererGL::drawMainCurve()
+void RendererGL::drawMainCurve(bool with_moving_point)
 {
-   glViewport( 0, 0, 1280, 1080 );
+   PROFILE_ZONE( "RendererGL::drawMainCurve" );
+
+   setViewport( 0, 0, 1280, 1080 );
    glClearColor( 0.72f, 0.72f, 0.77f, 1.0f );
    glClear( OPENGL_COLOR_BUFFER_BIT | OPENGL_DEPTH_BUFFER_BIT );
 
    drawAxisObject();
+   drawTrajectories();
 
-   if (!PositionMode && !PositionCurve.empty()) {
+   if (!PositionMode && getPositionCurveSampleNum() > 0) {
       drawCurve( PositionCurveObject.get() );
-      drawMovingPoint();
+      if (with_moving_point) drawMovingPoint();
    }
 }
 
-void RendererGL::drawPositionCurve() const
+void RendererGL::drawPositionCurve()
 {
+   PROFILE_ZONE( "RendererGL::drawPositionCurve" );
+
    glEnable( GL_SCISSOR_TEST );
-   glViewport( 1280, 540, 640, 540 );
+   setViewport( 1280, 540, 640, 540 );
    glScissor( 1280, 540, 640, 540 );
    glClearColor( 0.63f, 0.53f, 0.49f, 1.0f );
    glClear( OPENGL_COLOR_BUFFER_BIT | OPENGL_DEPTH_BUFFER_BIT );
@@ -477,17 +1159,19 @@ void RendererGL::drawPositionCurve() const
    }
    drawControlPoints( PositionObject.get() );
 
-   if (!PositionMode && !PositionCurve.empty()) {
+   if (!PositionMode && getPositionCurveSampleNum() > 0) {
       drawCurve( PositionCurveObject.get() );
    }
 
    glDisable( GL_SCISSOR_TEST );
 }
 
-void RendererGL::drawVelocityCurve() const
+void RendererGL::drawVelocityCurve()
 {
+   PROFILE_ZONE( "RendererGL::drawVelocityCurve" );
+
    glEnable( GL_SCISSOR_TEST );
-   glViewport( 1280, 0, 640, 540 );
+   setViewport( 1280, 0, 640, 540 );
    glScissor( 1280, 0, 640, 540 );
    glClearColor( 0.55f, 0.43f, 0.38f, 1.0f );
    glClear( OPENGL_COLOR_BUFFER_BIT | OPENGL_DEPTH_BUFFER_BIT );
@@ -499,36 +1183,501 @@ void RendererGL::drawVelocityCurve() const
    }
    drawControlPoints( VelocityObject.get() );
 
-   if (!VelocityMode && !VelocityCurve.empty()) {
+   if (!VelocityMode && getVelocityCurveSampleNum() > 0) {
       drawCurve( VelocityCurveObject.get() );
    }
 
    glDisable( GL_SCISSOR_TEST );
 }
 
+void RendererGL::drawObjectInPanels(ObjectGL* object, GLenum draw_mode, const glm::mat4& to_world, int panel_mask)
+{
+   const bool is_point = draw_mode == GL_POINTS;
+   ShaderGL* shader = is_point ? PanelPointShader.get() : PanelLineShader.get();
+   StateCache->useProgram( shader->getShaderProgram() );
+   StateCache->setBlending( false );
+   glUniform1i( shader->getLocation( is_point ? PanelPointMask : PanelLineMask ), panel_mask );
+   shader->transferBasicTransformationUniforms( to_world, MainCamera.get() );
+   object->transferUniformsToShader( shader );
+
+   StateCache->bindVertexArray( object->getVAO() );
+   glDrawArrays( draw_mode, 0, object->getVertexNum() );
+}
+
+void RendererGL::drawPanelsInOnePass(bool with_moving_point)
+{
+   PROFILE_ZONE( "RendererGL::drawPanelsInOnePass" );
+
+   // The viewport and scissor indices are the bit indices of PANEL.
+   const GLfloat viewports[] = {
+      0.0f, 0.0f, 1280.0f, 1080.0f,
+      1280.0f, 540.0f, 640.0f, 540.0f,
+      1280.0f, 0.0f, 640.0f, 540.0f
+   };
+   const GLint scissors[] = {
+      0, 0, 1280, 1080,
+      1280, 540, 640, 540,
+      1280, 0, 640, 540
+   };
+   const GLfloat clear_colors[] = {
+      0.72f, 0.72f, 0.77f, 1.0f,
+      0.63f, 0.53f, 0.49f, 1.0f,
+      0.55f, 0.43f, 0.38f, 1.0f
+   };
+   const GLfloat clear_depth = 1.0f;
+
+   // A clear only follows the first scissor box, so the panels are cleared one by one through it.
+   glClearBufferfv( GL_DEPTH, 0, &clear_depth );
+   glEnable( GL_SCISSOR_TEST );
+   for (int i = 0; i < 3; ++i) {
+      glScissorIndexedv( 0, scissors + i * 4 );
+      glClearBufferfv( GL_COLOR, 0, clear_colors + i * 4 );
+   }
+   glViewportArrayv( 0, 3, viewports );
+   glScissorArrayv( 0, 3, scissors );
+
+   StateCache->setLineWidth( 5.0f );
+   const glm::mat4 scale_matrix = scale( glm::mat4(1.0f), glm::vec3(1600.0f, 800.0f, 1.0f) );
+   const glm::mat4 translation = translate( glm::mat4(1.0f), glm::vec3(150.0f, 100.0f, 0.0f) );
+   const glm::mat4 rotation = glm::rotate( glm::mat4(1.0f), glm::radians( 90.0f ), glm::vec3(0.0f, 0.0f, 1.0f) );
+   const glm::mat4 to_world = translation * scale_matrix;
+   drawObjectInPanels( AxisObject.get(), AxisObject->getDrawMode(), to_world, ALL_PANELS );
+   drawObjectInPanels( AxisObject.get(), AxisObject->getDrawMode(), to_world * rotation, ALL_PANELS );
+   // Without a geometry shader, the draw goes through the first viewport, which is the main panel.
+   drawTrajectories();
+
+   if (PositionControlPoints.size() <= 4) PositionObject->updateDataBuffer( PositionControlPoints );
+   if (VelocityControlPoints.size() <= 4) VelocityObject->updateDataBuffer( VelocityControlPoints );
+
+   StateCache->setLineWidth( 3.0f );
+   const glm::mat4 identity(1.0f);
+   drawObjectInPanels( PositionObject.get(), PositionObject->getDrawMode(), identity, POSITION_PANEL );
+   drawObjectInPanels( VelocityObject.get(), VelocityObject->getDrawMode(), identity, VELOCITY_PANEL );
+   const bool position_curve_visible = !PositionMode && getPositionCurveSampleNum() > 0;
+   if (position_curve_visible) {
+      drawObjectInPanels(
+         PositionCurveObject.get(), PositionCurveObject->getDrawMode(), identity, MAIN_PANEL | POSITION_PANEL
+      );
+   }
+   if (!VelocityMode && getVelocityCurveSampleNum() > 0) {
+      drawObjectInPanels( VelocityCurveObject.get(), VelocityCurveObject->getDrawMode(), identity, VELOCITY_PANEL );
+   }
+
+   StateCache->setPointSize( 10.0f );
+   drawObjectInPanels( PositionObject.get(), GL_POINTS, identity, POSITION_PANEL );
+   drawObjectInPanels( VelocityObject.get(), GL_POINTS, identity, VELOCITY_PANEL );
+   if (with_moving_point && position_curve_visible && updateMovingPoint()) {
+      StateCache->setPointSize( 20.0f );
+      drawObjectInPanels( MovingObject.get(), GL_POINTS, identity, MAIN_PANEL );
+   }
+
+   glDisable( GL_SCISSOR_TEST );
+}
+
+void RendererGL::drawPanels(bool with_moving_point)
+{
+   if (MultiViewport) {
+      GPUTimer::Scope scope( *PassTimer, PanelPass );
+      drawPanelsInOnePass( with_moving_point );
+      return;
+   }
+
+   {
+      GPUTimer::Scope scope( *PassTimer, MainCurvePass );
+      drawMainCurve( with_moving_point );
+   }
+   {
+      GPUTimer::Scope scope( *PassTimer, PositionCurvePass );
+      drawPositionCurve();
+   }
+   {
+      GPUTimer::Scope scope( *PassTimer, VelocityCurvePass );
+      drawVelocityCurve();
+   }
+}
+
+void RendererGL::drawCachedLayer()
+{
+   PROFILE_ZONE( "RendererGL::drawCachedLayer" );
+
+   // Everything but the moving point changes only on the input, so it is redrawn into the layer only then.
+   if (LayerDirty) {
+      glBindFramebuffer( GL_FRAMEBUFFER, LayerFBO );
+      drawPanels( false );
+      glBindFramebuffer( GL_FRAMEBUFFER, OffscreenFBO );
+      LayerDirty = false;
+      LayerRedrawNum++;
+   }
+
+   GPUTimer::Scope scope( *PassTimer, LayerPass );
+   setViewport( 0, 0, LayerWidth, LayerHeight );
+   StateCache->useProgram( ObjectShader->getShaderProgram() );
+   StateCache->setBlending( false );
+   const glm::mat4 to_world = scale(
+      glm::mat4(1.0f), glm::vec3(static_cast<float>(LayerWidth), static_cast<float>(LayerHeight), 1.0f)
+   );
+   ObjectShader->transferBasicTransformationUniforms( to_world, MainCamera.get(), true );
+   LayerObject->transferUniformsToShader( ObjectShader.get() );
+   glBindTextureUnit( 0, LayerObject->getTextureID( LayerTextureIndex ) );
+   StateCache->bindVertexArray( LayerObject->getVAO() );
+   glDrawArrays( LayerObject->getDrawMode(), 0, LayerObject->getVertexNum() );
+
+   if (!PositionMode && getPositionCurveSampleNum() > 0) {
+      setViewport( 0, 0, 1280, 1080 );
+      drawMovingPoint();
+   }
+}
+
 void RendererGL::render()
 {
-   drawMainCurve();
-   drawPositionCurve();
-   drawVelocityCurve();
+   PROFILE_ZONE( "RendererGL::render" );
+
+   PassTimer->beginFrame();
+   StateCache->beginFrame();
+   if (CachedLayers) drawCachedLayer();
+   else drawPanels( true );
+
+   StateCache->bindVertexArray( 0 );
+   StateCache->useProgram( 0 );
+}
+
+void RendererGL::invalidate()
+{
+   // Every invalidating event may change the static contents of the panels.
+   LayerDirty = true;
+
+   // The latency is measured from the first event which invalidated the frame.
+   if (NeedsRedraw) return;
 
-   glBindVertexArray( 0 );
-   glUseProgram( 0 );
+   NeedsRedraw = true;
+   InvalidatedTime = std::chrono::steady_clock::now();
+}
+
+bool RendererGL::isAnimating() const
+{
+   // The point stays at the end of the curve after the last motion sample, so nothing changes from then on.
+   switch (MoveType) {
+      case MOVE_TYPE::UNIFORM: return FrameIndex < TotalPositionCurvePointNum;
+      case MOVE_TYPE::VARIABLE: return FrameIndex < TotalVelocityCurvePointNum;
+      case MOVE_TYPE::NONE:
+      default: return false;
+   }
+}
+
+bool RendererGL::isIdle() const
+{
+   // A decoded texture still has to be uploaded and drawn, so the frame is not final until then.
+   return !NeedsRedraw && !isAnimating() && !AsyncTextureLoader->hasDecodedImages();
+}
+
+void RendererGL::waitForInvalidation(double timeout_seconds)
+{
+   // The timeout only bounds the sleep; a timed-out wait without any event does not redraw.
+   const auto start = std::chrono::steady_clock::now();
+   if (QueuedInput) InputEvents->wait( timeout_seconds );
+   else glfwWaitEventsTimeout( timeout_seconds );
+   const std::chrono::duration<double> idle = std::chrono::steady_clock::now() - start;
+   Redraws.IdleSeconds += idle.count();
+   Redraws.WaitNum++;
+}
+
+void RendererGL::printRedrawStatistics(double elapsed_seconds, double cpu_seconds) const
+{
+   std::cout << "Redraws: " << Redraws.RedrawNum << " frames in " << elapsed_seconds << " s, idle "
+      << 100.0 * Redraws.IdleSeconds / std::max( elapsed_seconds, 1e-9 ) << "% of the time in "
+      << Redraws.WaitNum << " waits, CPU usage " << 100.0 * cpu_seconds / std::max( elapsed_seconds, 1e-9 ) << "%\n";
+   if (Redraws.LatencySampleNum > 0) {
+      const auto sample_num = static_cast<double>(Redraws.LatencySampleNum);
+      const double average = Redraws.TotalLatencyMilliseconds / sample_num;
+      const double variance = std::max( Redraws.TotalSquaredLatencyMilliseconds / sample_num - average * average, 0.0 );
+      std::cout << "Redraws: event to presented frame latency avg " << average << " ms, jitter (std dev) "
+         << std::sqrt( variance ) << " ms, max " << Redraws.MaxLatencyMilliseconds << " ms over "
+         << Redraws.LatencySampleNum << " events\n";
+   }
+   if (Redraws.QueuedEventNum > 0) {
+      std::cout << "Redraws: " << Redraws.QueuedEventNum << " events queued to the render thread, dispatch delay avg "
+         << Redraws.TotalQueueDelayMilliseconds / static_cast<double>(Redraws.QueuedEventNum) << " ms, max "
+         << Redraws.MaxQueueDelayMilliseconds << " ms";
+      if (InputEvents->getFullNum() > 0) std::cout << ", the queue was full " << InputEvents->getFullNum() << " times";
+      std::cout << "\n";
+   }
+}
+
+void RendererGL::printGPUMemoryUsage() const
+{
+   const std::pair<const char*, const ObjectGL*> objects[] = {
+      { "Axis", AxisObject.get() },
+      { "Position", PositionObject.get() },
+      { "Velocity", VelocityObject.get() },
+      { "PositionCurve", PositionCurveObject.get() },
+      { "VelocityCurve", VelocityCurveObject.get() },
+      { "Moving", MovingObject.get() },
+      { "Layer", LayerObject.get() }
+   };
+   GLsizeiptr total_size = 0;
+   std::cout << "GPU memory per object (buffers and textures):\n";
+   for (const auto& object : objects) {
+      const GLsizeiptr size = object.second->getGPUMemorySize();
+      total_size += size;
+      std::cout << " - " << std::left << std::setw( 16 ) << object.first << std::right
+         << static_cast<double>(size) / 1024.0 << " KiB";
+      if (object.second->getCustomBuffers().getBufferNum() > 0) {
+         std::cout << " (" << object.second->getCustomBuffers().getBufferNum() << " custom buffers)";
+      }
+      std::cout << "\n";
+   }
+   if (Trajectories->getCurveNum() > 0) {
+      total_size += Trajectories->getGPUMemorySize();
+      std::cout << " - " << std::left << std::setw( 16 ) << "Trajectories" << std::right
+         << static_cast<double>(Trajectories->getGPUMemorySize()) / 1024.0 << " KiB (" << Trajectories->getCurveNum()
+         << " curves)\n";
+   }
+   std::cout << " - " << std::left << std::setw( 16 ) << "Total" << std::right
+      << static_cast<double>(total_size) / 1024.0 << " KiB\n";
+}
+
+void RendererGL::dumpTrace()
+{
+   // The zones of all threads are in one process-wide registry, so the owner of several renderers dumps them.
+   if (RendererOptions.TracePath.empty()) return;
+
+   if (Profiler::getZoneNum() == 0 && Profiler::getDroppedZoneNum() == 0) {
+#ifdef ENABLE_PROFILER
+      std::cout << "No zones were profiled since the last dump.\n";
+#else
+      std::cout << "No zones are profiled; configure with ENABLE_PROFILER=ON.\n";
+#endif
+      return;
+   }
+
+   // Every dump drains the zones since the previous one, so the later dumps are numbered instead of overwriting it.
+   const std::string& path = RendererOptions.TracePath;
+   if (Profiler::dump( TraceDumpNum == 0 ? path : path + "." + std::to_string( TraceDumpNum ) )) TraceDumpNum++;
+}
+
+void RendererGL::startFrames()
+{
+   printGPUMemoryUsage();
+   Pacer->start();
+   if (!RendererOptions.RecordPath.empty()) {
+      if (Recorder->startRecording( RendererOptions.RecordPath, FrameWidth, FrameHeight )) {
+         std::cout << "Record the input into " << RendererOptions.RecordPath << "\n";
+      }
+   }
+   if (!RendererOptions.ReplayPath.empty()) {
+      Recorder->startReplaying( RendererOptions.ReplayPath, RendererOptions.ReplaySpeed, FrameWidth, FrameHeight );
+   }
+   if (!RendererOptions.CapturePath.empty()) {
+      if (Capturer->start( RendererOptions.CapturePath, FrameWidth, FrameHeight )) {
+         std::cout << "Capture the frames into " << RendererOptions.CapturePath << "\n";
+      }
+   }
+}
+
+void RendererGL::finishFrame()
+{
+   if (AsyncTextureLoader->finalize( TextureUploadBudget ) > 0) invalidate();
+   Capturer->capture();
+
+   constexpr uint64_t print_interval = 1000;
+   if (PassTimer->getFrameNum() % print_interval == 0) {
+      PassTimer->print();
+      StateCache->print();
+   }
+
+   if (std::this_thread::get_id() == EventThreadID) glfwPollEvents();
+   if (RendererOptions.Headless) glFlush();
+   else glfwSwapBuffers( Window );
+}
+
+void RendererGL::finishFrames()
+{
+   Recorder->finishRecording();
+   Recorder->finishReplaying();
+   Pacer->finish();
+   Pacer->print();
+   Capturer->finish();
+   PassTimer->print();
+   PassTimer->destroyQueries();
+   StateCache->print();
+   StateCache->invalidate();
+   AsyncTextureLoader->print();
+   AsyncTextureLoader->destroyStagingBuffer();
+   if (LayerRedrawNum > 0) std::cout << "The static layer was redrawn " << LayerRedrawNum << " times.\n";
+   destroyLayerTarget();
+   if (Profiler::getZoneNum() > 0 || Profiler::getDroppedZoneNum() > 0) dumpTrace();
+   destroyOffscreenTarget();
+}
+
+void RendererGL::renderFrames()
+{
+   // Identical frames are not drawn again: it renders only when an event invalidated the frame or the point is
+   // moving, and blocks in the event queue otherwise.
+   while (!glfwWindowShouldClose( Window )) {
+      if (QueuedInput) dispatchEvents();
+      if (Recorder->isReplaying()) replayEvents();
+      if (isIdle()) {
+         constexpr double timeout_seconds = 0.5;
+         waitForInvalidation(
+            Recorder->isReplaying() ? std::min( timeout_seconds, Recorder->getSecondsToNextEvent() ) : timeout_seconds
+         );
+         continue;
+      }
+
+      const bool invalidated = NeedsRedraw;
+      const auto invalidated_time = InvalidatedTime;
+      NeedsRedraw = false;
+      Pacer->beginFrame();
+      render();
+      finishFrame();
+      Pacer->endFrame( invalidated, invalidated_time );
+      Redraws.RedrawNum++;
+      if (invalidated) {
+         const std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - invalidated_time;
+         Redraws.TotalLatencyMilliseconds += latency.count();
+         Redraws.TotalSquaredLatencyMilliseconds += latency.count() * latency.count();
+         Redraws.MaxLatencyMilliseconds = std::max( Redraws.MaxLatencyMilliseconds, latency.count() );
+         Redraws.LatencySampleNum++;
+      }
+   }
+}
+
+void RendererGL::renderOnRenderThread()
+{
+   // The render thread owns the context from now on, and this thread only pumps the events into the queue,
+   // so a slow curve rebuild or upload does not hold the input back and vice versa.
+   QueuedInput = true;
+   glfwMakeContextCurrent( nullptr );
+   std::thread render_thread(
+      [this]()
+      {
+         glfwMakeContextCurrent( Window );
+         renderFrames();
+         glfwMakeContextCurrent( nullptr );
+
+         // The window can be closed by a key, while the event thread is blocked in glfwWaitEvents.
+         glfwPostEmptyEvent();
+      }
+   );
+   while (!glfwWindowShouldClose( Window )) glfwWaitEvents();
+   InputEvents->wake();
+   render_thread.join();
+
+   glfwMakeContextCurrent( Window );
+   QueuedInput = false;
 }
 
 void RendererGL::play()
 {
    if (glfwWindowShouldClose( Window )) initialize();
 
-   setAxisObject();
-   setCurveObjects();
-   ObjectShader->setUniformLocations( 0 );
+   setObjects();
+   startFrames();
+
+   // The first frame is forced, so its latency is measured from here rather than from a stale invalidation.
+   NeedsRedraw = true;
+   InvalidatedTime = std::chrono::steady_clock::now();
+   Redraws = RedrawStatistics();
+   const std::clock_t cpu_start = std::clock();
+   const auto start = std::chrono::steady_clock::now();
+   if (RendererOptions.RenderThread) renderOnRenderThread();
+   else renderFrames();
+   const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+   const double cpu_seconds = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+   finishFrames();
+   printRedrawStatistics( elapsed.count(), cpu_seconds );
+}
 
-   while (!glfwWindowShouldClose( Window )) {
+bool RendererGL::benchmark(int frame_num)
+{
+   if (glfwWindowShouldClose( Window )) initialize();
+   glfwMakeContextCurrent( Window );
+
+   setObjects();
+   setBenchmarkCurves();
+   startFrames();
+
+   // The first frames may still grow the buffers, so the allocations are checked after them.
+   constexpr int warm_up_frame_num = 10;
+   const int motion_frame_num = std::max( TotalPositionCurvePointNum, TotalVelocityCurvePointNum );
+   int rendered_frame_num = 0, allocating_frame_num = 0;
+   uint64_t steady_allocation_num = 0;
+   const auto start = std::chrono::steady_clock::now();
+   while (rendered_frame_num < frame_num && !glfwWindowShouldClose( Window )) {
+      if (rendered_frame_num % motion_frame_num == 0) {
+         MoveType = (rendered_frame_num / motion_frame_num) % 2 == 0 ? MOVE_TYPE::UNIFORM : MOVE_TYPE::VARIABLE;
+         FrameIndex = 0;
+      }
+
+      Pacer->beginFrame();
+      AllocationCounter::beginFrame();
       render();
-      
-      glfwPollEvents();
-      glfwSwapBuffers( Window );
+      const uint64_t allocation_num = AllocationCounter::getFrameAllocationNum();
+      if (rendered_frame_num >= warm_up_frame_num && allocation_num > 0) {
+         steady_allocation_num += allocation_num;
+         allocating_frame_num++;
+      }
+      rendered_frame_num++;
+
+      finishFrame();
+      Pacer->endFrame( false, std::chrono::steady_clock::time_point() );
+   }
+   glFinish();
+   const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+   finishFrames();
+   glfwMakeContextCurrent( nullptr );
+
+   std::cout << "Benchmark: " << rendered_frame_num << " frames in " << elapsed.count() << " s ("
+      << static_cast<double>(rendered_frame_num) / elapsed.count() << " fps, "
+      << 1000.0 * elapsed.count() / static_cast<double>(std::max( rendered_frame_num, 1 )) << " ms/frame)\n";
+   if (!AllocationCounter::isEnabled()) {
+      std::cout << "Benchmark: allocations are not tracked; configure with TRACK_ALLOCATIONS=ON to check them.\n";
+      return true;
    }
+
+   std::cout << "Benchmark: " << steady_allocation_num << " allocations in " << allocating_frame_num
+      << " frames after " << warm_up_frame_num << " warm-up frames\n";
+   return steady_allocation_num == 0;
+}
+
+bool RendererGL::benchmarkTextureLoading(const std::vector<std::string>& file_paths)
+{
+   if (glfwWindowShouldClose( Window )) initialize();
+
+   // Each load finishes on the GPU before the clock stops, so the upload is included.
+   const auto measure = [](const std::function<int()>& load, int& index)
+   {
+      const auto start = std::chrono::steady_clock::now();
+      index = load();
+      glFinish();
+      const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      return elapsed.count();
+   };
+
+   bool succeeded = true;
+   double direct_total = 0.0, cold_total = 0.0, warm_total = 0.0;
+   std::cout << "Texture loading in ms (FreeImage / cold cache / warm cache), cached in "
+      << TexelCache->getDirectoryPath().string() << ":\n";
+   for (const auto& file_path : file_paths) {
+      ObjectGL object;
+      int direct_index = -1, cold_index = -1, warm_index = -1;
+      const double direct = measure( [&]() { return object.addTexture( file_path ); }, direct_index );
+      TexelCache->remove( file_path, false );
+      const double cold = measure( [&]() { return object.addTexture( *TexelCache, file_path ); }, cold_index );
+      const double warm = measure( [&]() { return object.addTexture( *TexelCache, file_path ); }, warm_index );
+      if (direct_index < 0 || cold_index < 0 || warm_index < 0) {
+         succeeded = false;
+         continue;
+      }
+
+      direct_total += direct;
+      cold_total += cold;
+      warm_total += warm;
+      std::cout << " - " << file_path << ": " << direct << " / " << cold << " / " << warm << "\n";
+   }
+   std::cout << "Total: " << direct_total << " / " << cold_total << " / " << warm_total << " ms ("
+      << TexelCache->getHitNum() << " hits, " << TexelCache->getMissNum() << " misses)\n";
+
    glfwDestroyWindow( Window );
+   return succeeded;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Shader.h"
+#include "Profiler.h"
 
 ShaderGL::ShaderGL() : ShaderProgram( 0 )
 {
@@ -72,14 +73,105 @@ GLuint ShaderGL::getCompiledShader(GLenum shader_type, const char* shader_path)
    return shader;
 }
 
+bool ShaderGL::checkLinkError(GLuint program)
+{
+   GLint linked = 0;
+   glGetProgramiv( program, GL_LINK_STATUS, &linked );
+
+   if (linked == GL_FALSE) {
+      GLint max_length = 0;
+      glGetProgramiv( program, GL_INFO_LOG_LENGTH, &max_length );
+
+      std::cerr << " ======= Program log ======= \n";
+      std::vector<GLchar> error_log(std::max( max_length, 1 ));
+      glGetProgramInfoLog( program, max_length, &max_length, &error_log[0] );
+      for (const auto& c : error_log) std::cerr << c;
+      std::cerr << "\n";
+   }
+   return linked == GL_TRUE;
+}
+
+void ShaderGL::reflectUniforms(GLuint program)
+{
+   Uniforms.erase(
+      std::remove_if( Uniforms.begin(), Uniforms.end(), [program](const UniformInfo& u) { return u.Program == program; } ),
+      Uniforms.end()
+   );
+
+   GLint uniform_num = 0, max_name_length = 0;
+   glGetProgramInterfaceiv( program, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniform_num );
+   glGetProgramInterfaceiv( program, GL_UNIFORM, GL_MAX_NAME_LENGTH, &max_name_length );
+
+   const GLenum properties[] = { GL_BLOCK_INDEX, GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE };
+   constexpr auto property_num = static_cast<GLsizei>(std::size( properties ));
+   std::vector<GLchar> name(std::max( max_name_length, 1 ));
+   for (GLint i = 0; i < uniform_num; ++i) {
+      GLint values[property_num];
+      glGetProgramResourceiv( program, GL_UNIFORM, i, property_num, properties, property_num, nullptr, values );
+
+      // The members of the uniform blocks are set through their buffers, so they have no locations.
+      if (values[0] != -1) continue;
+
+      GLsizei length = 0;
+      glGetProgramResourceName( program, GL_UNIFORM, i, max_name_length, &length, name.data() );
+      std::string uniform_name( name.data(), length );
+      const std::string array_suffix = "[0]";
+      if (uniform_name.size() > array_suffix.size() &&
+          uniform_name.compare( uniform_name.size() - array_suffix.size(), array_suffix.size(), array_suffix ) == 0) {
+         uniform_name.resize( uniform_name.size() - array_suffix.size() );
+      }
+      Uniforms.emplace_back( std::move( uniform_name ), program, static_cast<GLenum>(values[1]), values[2], values[3] );
+   }
+   std::sort(
+      Uniforms.begin(), Uniforms.end(),
+      [](const UniformInfo& a, const UniformInfo& b) { return std::tie( a.Program, a.Name ) < std::tie( b.Program, b.Name ); }
+   );
+}
+
+bool ShaderGL::checkUniforms(GLuint program, const std::vector<std::string>& names) const
+{
+   // A name missing from the table would give an invalid handle, whose uniform is silently never set.
+   bool found = true;
+   for (const auto& name : names) {
+      if (findUniform( program, name ) >= 0) continue;
+
+      std::cerr << "The uniform " << name << " is not active in the linked program.\n";
+      found = false;
+   }
+   return found;
+}
+
+int ShaderGL::findUniform(GLuint program, const std::string& name) const
+{
+   const auto it = std::lower_bound(
+      Uniforms.begin(), Uniforms.end(), std::tie( program, name ),
+      [](const UniformInfo& u, const std::tuple<const GLuint&, const std::string&>& key)
+      {
+         return std::tie( u.Program, u.Name ) < key;
+      }
+   );
+   if (it == Uniforms.end() || it->Program != program || it->Name != name) return -1;
+   return static_cast<int>(it - Uniforms.begin());
+}
+
+GLint ShaderGL::findLocation(const std::string& name) const
+{
+   // The basic uniforms are optional, so a missing one is not reported.
+   const int index = findUniform( ShaderProgram, name );
+   return index < 0 ? -1 : Uniforms[index].Location;
+}
+
 void ShaderGL::setShader(
    const char* vertex_shader_path,
    const char* fragment_shader_path,
    const char* geometry_shader_path,
    const char* tessellation_control_shader_path,
-   const char* tessellation_evaluation_shader_path
+   const char* tessellation_evaluation_shader_path,
+   const std::vector<std::string>& uniform_names
 )
 {
+   PROFILE_ZONE( "ShaderGL::setShader" );
+
    const GLuint vertex_shader = getCompiledShader( GL_VERTEX_SHADER, vertex_shader_path );
    const GLuint fragment_shader = getCompiledShader( GL_FRAGMENT_SHADER, fragment_shader_path );
    const GLuint geometry_shader = getCompiledShader( GL_GEOMETRY_SHADER, geometry_shader_path );
@@ -92,6 +184,9 @@ void ShaderGL::setShader(
    if (tessellation_control_shader != 0) glAttachShader( ShaderProgram, tessellation_control_shader );
    if (tessellation_evaluation_shader != 0) glAttachShader( ShaderProgram, tessellation_evaluation_shader );
    glLinkProgram( ShaderProgram );
+   if (!checkLinkError( ShaderProgram )) std::cerr << "Could not link shader\n";
+   reflectUniforms( ShaderProgram );
+   if (!checkUniforms( ShaderProgram, uniform_names )) std::cerr << "Could not find the uniforms of shader\n";
    glDeleteShader( vertex_shader );
    glDeleteShader( fragment_shader );
    if (geometry_shader != 0) glDeleteShader( geometry_shader );
@@ -99,7 +194,10 @@ void ShaderGL::setShader(
    if (tessellation_evaluation_shader != 0) glDeleteShader( tessellation_evaluation_shader );
 }
 
-void ShaderGL::setComputeShaders(const std::vector<const char*>& compute_shader_paths)
+void ShaderGL::setComputeShaders(
+   const std::vector<const char*>& compute_shader_paths,
+   const std::vector<std::vector<std::string>>& uniform_names
+)
 {
    ComputeShaderPrograms.clear();
    ComputeShaderPrograms.resize( compute_shader_paths.size() );
@@ -108,57 +206,91 @@ void ShaderGL::setComputeShaders(const std::vector<const char*>& compute_shader_
       ComputeShaderPrograms[i] = glCreateProgram();
       glAttachShader( ComputeShaderPrograms[i], compute_shader );
       glLinkProgram( ComputeShaderPrograms[i] );
+      if (!checkLinkError( ComputeShaderPrograms[i] )) std::cerr << "Could not link compute shader\n";
+      reflectUniforms( ComputeShaderPrograms[i] );
+      if (i < uniform_names.size() && !checkUniforms( ComputeShaderPrograms[i], uniform_names[i] )) {
+         std::cerr << "Could not find the uniforms of compute shader\n";
+      }
       glDeleteShader( compute_shader );
    }
 }
 
 void ShaderGL::setBasicTransformationUniforms()
 {
-   Location.World = glGetUniformLocation( ShaderProgram, "WorldMatrix" );
-   Location.View = glGetUniformLocation( ShaderProgram, "ViewMatrix" );
-   Location.Projection = glGetUniformLocation( ShaderProgram, "ProjectionMatrix" );
-   Location.ModelViewProjection = glGetUniformLocation( ShaderProgram, "ModelViewProjectionMatrix" );
+   Location.World = findLocation( "WorldMatrix" );
+   Location.View = findLocation( "ViewMatrix" );
+   Location.Projection = findLocation( "ProjectionMatrix" );
+   Location.ModelViewProjection = findLocation( "ModelViewProjectionMatrix" );
+   Location.VertexOffset = findLocation( "VertexOffset" );
+   Location.VertexScale = findLocation( "VertexScale" );
+}
+
+void ShaderGL::setLightUniforms(int light_num)
+{
+   // The members of Lights[i] are found by parsing the reflected names once instead of building them per light.
+   LightLocationSet inactive_light;
+   inactive_light.LightSwitch = inactive_light.LightPosition = inactive_light.LightAmbient = -1;
+   inactive_light.LightDiffuse = inactive_light.LightSpecular = inactive_light.LightFallOffRadius = -1;
+   inactive_light.SpotlightDirection = inactive_light.SpotlightCutoffAngle = inactive_light.SpotlightFeather = -1;
+   Location.Lights.assign( light_num, inactive_light );
+   const std::string prefix = "Lights[";
+   for (const auto& uniform : Uniforms) {
+      if (uniform.Program != ShaderProgram || uniform.Name.compare( 0, prefix.size(), prefix ) != 0) continue;
+
+      const size_t index_end = uniform.Name.find( "].", prefix.size() );
+      if (index_end == std::string::npos) continue;
+
+      const int light_index = std::atoi( uniform.Name.c_str() + prefix.size() );
+      if (light_index < 0 || light_index >= light_num) continue;
+
+      LightLocationSet& light = Location.Lights[light_index];
+      const std::string member = uniform.Name.substr( index_end + 2 );
+      if (member == "LightSwitch") light.LightSwitch = uniform.Location;
+      else if (member == "Position") light.LightPosition = uniform.Location;
+      else if (member == "AmbientColor") light.LightAmbient = uniform.Location;
+      else if (member == "DiffuseColor") light.LightDiffuse = uniform.Location;
+      else if (member == "SpecularColor") light.LightSpecular = uniform.Location;
+      else if (member == "SpotlightDirection") light.SpotlightDirection = uniform.Location;
+      else if (member == "SpotlightCutoffAngle") light.SpotlightCutoffAngle = uniform.Location;
+      else if (member == "SpotlightFeather") light.SpotlightFeather = uniform.Location;
+      else if (member == "FallOffRadius") light.LightFallOffRadius = uniform.Location;
+   }
 }
 
 void ShaderGL::setUniformLocations(int light_num)
 {
    setBasicTransformationUniforms();
 
-   Location.MaterialEmission = glGetUniformLocation( ShaderProgram, "Material.EmissionColor" );
-   Location.MaterialAmbient = glGetUniformLocation( ShaderProgram, "Material.AmbientColor" );
-   Location.MaterialDiffuse = glGetUniformLocation( ShaderProgram, "Material.DiffuseColor" );
-   Location.MaterialSpecular = glGetUniformLocation( ShaderProgram, "Material.SpecularColor" );
-   Location.MaterialSpecularExponent = glGetUniformLocation( ShaderProgram, "Material.SpecularExponent" );
-
-   Location.Texture[0] = glGetUniformLocation( ShaderProgram, "BaseTexture" );
-   Location.UseTexture = glGetUniformLocation( ShaderProgram, "UseTexture" );
-
-   Location.UseLight = glGetUniformLocation( ShaderProgram, "UseLight" );
-   Location.LightNum = glGetUniformLocation( ShaderProgram, "LightNum" );
-   Location.GlobalAmbient = glGetUniformLocation( ShaderProgram, "GlobalAmbient" );
-
-   Location.Lights.resize( light_num );
-   for (int i = 0; i < light_num; ++i) {
-      Location.Lights[i].LightSwitch = glGetUniformLocation( ShaderProgram, std::string("Lights[" + std::to_string( i ) + "].LightSwitch").c_str() );
-      Location.Lights[i].LightPosition = glGetUniformLocation( ShaderProgram, std::string("Lights[" + std::to_string( i ) + "].Position").c_str() );
-      Location.Lights[i].LightAmbient = glGetUniformLocation( ShaderProgram, std::string("Lights[" + std::to_string( i ) + "].AmbientColor").c_str() );
-      Location.Lights[i].LightDiffuse = glGetUniformLocation( ShaderProgram, std::string("Lights[" + std::to_string( i ) + "].DiffuseColor").c_str() );
-      Location.Lights[i].LightSpecular = glGetUniformLocation( ShaderProgram, std::string("Lights[" + std::to_string( i ) + "].SpecularColor").c_str() );
-      Location.Lights[i].SpotlightDirection = glGetUniformLocation( ShaderProgram, std::string("Lights[" + std::to_string( i ) + "].SpotlightDirection").c_str() );
-      Location.Lights[i].SpotlightCutoffAngle = glGetUniformLocation( ShaderProgram, std::string("Lights[" + std::to_string( i ) + "].SpotlightCutoffAngle").c_str() );
-      Location.Lights[i].SpotlightFeather = glGetUniformLocation( ShaderProgram, std::string("Lights[" + std::to_string( i ) + "].SpotlightFeather").c_str() );
-      Location.Lights[i].LightFallOffRadius = glGetUniformLocation( ShaderProgram, std::string("Lights[" + std::to_string( i ) + "].FallOffRadius").c_str() );
-   }
+   Location.MaterialEmission = findLocation( "Material.EmissionColor" );
+   Location.MaterialAmbient = findLocation( "Material.AmbientColor" );
+   Location.MaterialDiffuse = findLocation( "Material.DiffuseColor" );
+   Location.MaterialSpecular = findLocation( "Material.SpecularColor" );
+   Location.MaterialSpecularExponent = findLocation( "Material.SpecularExponent" );
+
+   Location.Texture.clear();
+   const GLint base_texture = findLocation( "BaseTexture" );
+   if (base_texture >= 0) Location.Texture.emplace_back( 0, base_texture );
+   Location.UseTexture = findLocation( "UseTexture" );
+
+   Location.UseLight = findLocation( "UseLight" );
+   Location.LightNum = findLocation( "LightNum" );
+   Location.GlobalAmbient = findLocation( "GlobalAmbient" );
+
+   setLightUniforms( light_num );
 }
 
-void ShaderGL::addUniformLocation(const std::string& name)
+ShaderGL::UniformHandle ShaderGL::addUniformLocation(const std::string& name)
 {
-   CustomLocations[name] = glGetUniformLocation( ShaderProgram, name.c_str() );
+   const int index = findUniform( ShaderProgram, name );
+   if (index < 0) std::cerr << "The uniform " << name << " is not active in the shader program.\n";
+   return UniformHandle( index );
 }
 
-void ShaderGL::addUniformLocationToComputeShader(const std::string& name, int shader_index)
+ShaderGL::UniformHandle ShaderGL::addUniformLocationToComputeShader(const std::string& name, int shader_index)
 {
-   CustomLocations[name] = glGetUniformLocation( ComputeShaderPrograms[shader_index], name.c_str() );
+   const int index = findUniform( ComputeShaderPrograms[shader_index], name );
+   if (index < 0) std::cerr << "The uniform " << name << " is not active in the compute shader " << shader_index << ".\n";
+   return UniformHandle( index );
 }
 
 void ShaderGL::transferBasicTransformationUniforms(const glm::mat4& to_world, const CameraGL* camera, bool use_texture) const
@@ -172,7 +304,7 @@ void ShaderGL::transferBasicTransformationUniforms(const glm::mat4& to_world, co
    glUniformMatrix4fv( Location.ModelViewProjection, 1, GL_FALSE, &model_view_projection[0][0] );
 
    for (const auto& texture : Location.Texture) {
-      glUniform1i( texture.second, texture.first );
+      glUniform1i( texture.Location, texture.Binding );
    }
    glUniform1i( Location.UseTexture, use_texture ? 1 : 0 );
 }
\ No newline at end of file
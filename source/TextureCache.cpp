@@ -0,0 +1,283 @@
+#include "TextureCache.h"
+#include "TextureLoader.h"
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+TextureCache::MappedFile::MappedFile() :
+   Data( nullptr ), Size( 0 )
+#ifdef _WIN32
+   , File( INVALID_HANDLE_VALUE ), Mapping( nullptr )
+#endif
+{
+}
+
+TextureCache::MappedFile::~MappedFile()
+{
+   close();
+}
+
+bool TextureCache::MappedFile::open(const std::filesystem::path& file_path)
+{
+   close();
+
+#ifdef _WIN32
+   File = CreateFileW(
+      file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+   );
+   if (File == INVALID_HANDLE_VALUE) return false;
+
+   LARGE_INTEGER file_size;
+   if (!GetFileSizeEx( File, &file_size ) || file_size.QuadPart == 0) {
+      close();
+      return false;
+   }
+   Mapping = CreateFileMappingW( File, nullptr, PAGE_READONLY, 0, 0, nullptr );
+   if (Mapping == nullptr) {
+      close();
+      return false;
+   }
+   Data = static_cast<const uchar*>(MapViewOfFile( Mapping, FILE_MAP_READ, 0, 0, 0 ));
+   if (Data == nullptr) {
+      close();
+      return false;
+   }
+   Size = static_cast<size_t>(file_size.QuadPart);
+#else
+   // The mapping keeps the file alive, so the descriptor is not needed after mapping it.
+   const int file_descriptor = ::open( file_path.c_str(), O_RDONLY );
+   if (file_descriptor < 0) return false;
+
+   struct stat file_status{};
+   if (fstat( file_descriptor, &file_status ) != 0 || file_status.st_size == 0) {
+      ::close( file_descriptor );
+      return false;
+   }
+   void* data = mmap( nullptr, static_cast<size_t>(file_status.st_size), PROT_READ, MAP_PRIVATE, file_descriptor, 0 );
+   ::close( file_descriptor );
+   if (data == MAP_FAILED) return false;
+
+   Data = static_cast<const uchar*>(data);
+   Size = static_cast<size_t>(file_status.st_size);
+#endif
+   return true;
+}
+
+void TextureCache::MappedFile::close()
+{
+#ifdef _WIN32
+   if (Data != nullptr) UnmapViewOfFile( Data );
+   if (Mapping != nullptr) CloseHandle( Mapping );
+   if (File != INVALID_HANDLE_VALUE) CloseHandle( File );
+   Mapping = nullptr;
+   File = INVALID_HANDLE_VALUE;
+#else
+   if (Data != nullptr) munmap( const_cast<uchar*>(Data), Size );
+#endif
+   Data = nullptr;
+   Size = 0;
+}
+
+TextureCache::TextureCache(std::filesystem::path directory_path) :
+   DirectoryPath( std::move( directory_path ) ), HitNum( 0 ), MissNum( 0 )
+{
+}
+
+std::filesystem::path TextureCache::getDefaultDirectoryPath()
+{
+   std::error_code error;
+   const std::filesystem::path temporary_path = std::filesystem::temp_directory_path( error );
+   return (error ? std::filesystem::path(".") : temporary_path) / "MovingPointOnBezierCurve" / "textures";
+}
+
+std::filesystem::path TextureCache::getCachePath(const std::string& file_path, bool is_grayscale) const
+{
+   std::error_code error;
+   const std::string key = std::filesystem::absolute( file_path, error ).string() + (is_grayscale ? "#R8" : "#RGBA8");
+
+   // FNV-1a
+   uint64_t hash = 14695981039346656037ull;
+   for (const char c : key) {
+      hash ^= static_cast<uchar>(c);
+      hash *= 1099511628211ull;
+   }
+   std::ostringstream name;
+   name << std::hex << std::setw( 16 ) << std::setfill( '0' ) << hash << ".tex";
+   return DirectoryPath / name.str();
+}
+
+size_t TextureCache::getLevelSize(const FileHeader& header, uint32_t level)
+{
+   const size_t width = std::max( header.Width >> level, 1u );
+   const size_t height = std::max( header.Height >> level, 1u );
+   return width * height * header.ChannelNum;
+}
+
+bool TextureCache::isValid(
+   const MappedFile& file,
+   const std::string& source_path,
+   int64_t source_modified_time,
+   uint64_t source_size
+)
+{
+   if (file.getSize() < sizeof( FileHeader )) return false;
+
+   FileHeader header{};
+   std::memcpy( &header, file.getData(), sizeof( FileHeader ) );
+   if (std::memcmp( header.Magic, "MPTX", 4 ) != 0 || header.Version != Version) return false;
+   if (header.SourceModifiedTime != source_modified_time || header.SourceSize != source_size) return false;
+   if (header.ChannelNum != 1 && header.ChannelNum != 4) return false;
+   if (header.Width == 0 || header.Height == 0 || header.LevelNum == 0) return false;
+   if (header.SourcePathLength != source_path.size()) return false;
+   if (header.DataOffset < sizeof( FileHeader ) + header.SourcePathLength) return false;
+
+   const auto* path = reinterpret_cast<const char*>(file.getData() + sizeof( FileHeader ));
+   if (source_path.compare( 0, source_path.size(), path, header.SourcePathLength ) != 0) return false;
+
+   size_t data_size = 0;
+   for (uint32_t level = 0; level < header.LevelNum; ++level) data_size += getLevelSize( header, level );
+   return file.getSize() >= header.DataOffset + data_size;
+}
+
+void TextureCache::buildLevels(
+   std::vector<uchar>& levels,
+   const FileHeader& header,
+   const uchar* bits,
+   size_t pitch
+)
+{
+   size_t total_size = 0;
+   for (uint32_t level = 0; level < header.LevelNum; ++level) total_size += getLevelSize( header, level );
+   levels.resize( total_size );
+
+   // The rows of FreeImage are padded to 4 bytes, but the levels are packed tightly.
+   const size_t channel_num = header.ChannelNum;
+   const size_t row_size = header.Width * channel_num;
+   for (size_t y = 0; y < header.Height; ++y) {
+      std::copy_n( bits + y * pitch, row_size, levels.data() + y * row_size );
+   }
+
+   // Each level is the 2x2 box filter of the previous one, clamping at the edges of the odd sizes.
+   const uchar* previous = levels.data();
+   uchar* current = levels.data() + getLevelSize( header, 0 );
+   for (uint32_t level = 1; level < header.LevelNum; ++level) {
+      const size_t previous_width = std::max( header.Width >> (level - 1), 1u );
+      const size_t previous_height = std::max( header.Height >> (level - 1), 1u );
+      const size_t width = std::max( header.Width >> level, 1u );
+      const size_t height = std::max( header.Height >> level, 1u );
+      for (size_t y = 0; y < height; ++y) {
+         const size_t y0 = std::min( 2 * y, previous_height - 1 );
+         const size_t y1 = std::min( 2 * y + 1, previous_height - 1 );
+         for (size_t x = 0; x < width; ++x) {
+            const size_t x0 = std::min( 2 * x, previous_width - 1 );
+            const size_t x1 = std::min( 2 * x + 1, previous_width - 1 );
+            for (size_t c = 0; c < channel_num; ++c) {
+               const uint sum =
+                  previous[(y0 * previous_width + x0) * channel_num + c] +
+                  previous[(y0 * previous_width + x1) * channel_num + c] +
+                  previous[(y1 * previous_width + x0) * channel_num + c] +
+                  previous[(y1 * previous_width + x1) * channel_num + c];
+               current[(y * width + x) * channel_num + c] = static_cast<uchar>((sum + 2) / 4);
+            }
+         }
+      }
+      previous = current;
+      current += width * height * channel_num;
+   }
+}
+
+void TextureCache::uploadLevels(GLuint texture, const FileHeader& header, const uchar* levels)
+{
+   const bool is_grayscale = header.ChannelNum == 1;
+   const auto width = static_cast<GLsizei>(header.Width);
+   const auto height = static_cast<GLsizei>(header.Height);
+   glTextureStorage2D( texture, static_cast<GLsizei>(header.LevelNum), is_grayscale ? GL_R8 : GL_RGBA8, width, height );
+   glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+   for (uint32_t level = 0; level < header.LevelNum; ++level) {
+      glTextureSubImage2D(
+         texture, static_cast<GLint>(level), 0, 0,
+         std::max( width >> level, 1 ), std::max( height >> level, 1 ),
+         is_grayscale ? GL_RED : GL_BGRA, GL_UNSIGNED_BYTE, levels
+      );
+      levels += getLevelSize( header, level );
+   }
+   glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+}
+
+bool TextureCache::upload(GLuint texture, const std::string& file_path, bool is_grayscale)
+{
+   std::error_code error;
+   const std::string source_path = std::filesystem::absolute( file_path, error ).string();
+   const auto modified_time = std::filesystem::last_write_time( file_path, error );
+   if (error) return false;
+   const uint64_t source_size = std::filesystem::file_size( file_path, error );
+   if (error) return false;
+   const int64_t source_modified_time = modified_time.time_since_epoch().count();
+
+   const std::filesystem::path cache_path = getCachePath( file_path, is_grayscale );
+   {
+      MappedFile file;
+      if (file.open( cache_path ) && isValid( file, source_path, source_modified_time, source_size )) {
+         FileHeader header{};
+         std::memcpy( &header, file.getData(), sizeof( FileHeader ) );
+         uploadLevels( texture, header, file.getData() + header.DataOffset );
+         HitNum++;
+         return true;
+      }
+   }
+
+   MissNum++;
+   FIBITMAP* bitmap = TextureLoader::decode( file_path, is_grayscale );
+   if (bitmap == nullptr) return false;
+
+   FileHeader header{};
+   std::memcpy( header.Magic, "MPTX", 4 );
+   header.Version = Version;
+   header.SourceModifiedTime = source_modified_time;
+   header.SourceSize = source_size;
+   header.Width = FreeImage_GetWidth( bitmap );
+   header.Height = FreeImage_GetHeight( bitmap );
+   header.LevelNum = 1 + static_cast<uint32_t>(std::floor( std::log2( std::max( header.Width, header.Height ) ) ));
+   header.ChannelNum = is_grayscale ? 1 : 4;
+   header.SourcePathLength = static_cast<uint32_t>(source_path.size());
+   header.DataOffset = static_cast<uint32_t>((sizeof( FileHeader ) + source_path.size() + 15) & ~size_t(15));
+
+   std::vector<uchar> levels;
+   buildLevels( levels, header, FreeImage_GetBits( bitmap ), FreeImage_GetPitch( bitmap ) );
+   FreeImage_Unload( bitmap );
+   uploadLevels( texture, header, levels.data() );
+
+   // The file is written aside and renamed, so a reader never maps a half-written file.
+   std::filesystem::create_directories( DirectoryPath, error );
+   std::filesystem::path temporary_path = cache_path;
+   temporary_path += ".tmp";
+   std::ofstream file( temporary_path, std::ios::out | std::ios::binary | std::ios::trunc );
+   if (!file.is_open()) {
+      std::cerr << "Cannot write the texture cache file: " << temporary_path.string() << "\n";
+      return true;
+   }
+   const std::vector<char> padding( header.DataOffset - sizeof( FileHeader ) - source_path.size(), 0 );
+   file.write( reinterpret_cast<const char*>(&header), sizeof( FileHeader ) );
+   file.write( source_path.data(), static_cast<std::streamsize>(source_path.size()) );
+   file.write( padding.data(), static_cast<std::streamsize>(padding.size()) );
+   file.write( reinterpret_cast<const char*>(levels.data()), static_cast<std::streamsize>(levels.size()) );
+   file.close();
+   if (file.fail()) std::filesystem::remove( temporary_path, error );
+   else std::filesystem::rename( temporary_path, cache_path, error );
+   return true;
+}
+
+void TextureCache::remove(const std::string& file_path, bool is_grayscale) const
+{
+   std::error_code error;
+   std::filesystem::remove( getCachePath( file_path, is_grayscale ), error );
+}
\ No newline at end of file
@@ -0,0 +1,245 @@
+#include "TextureLoader.h"
+
+bool TextureLoader::Handle::isReady() const
+{
+   return LoadRequest != nullptr && LoadRequest->State.load( std::memory_order_acquire ) == STATE::READY;
+}
+
+bool TextureLoader::Handle::hasFailed() const
+{
+   return LoadRequest != nullptr && LoadRequest->State.load( std::memory_order_acquire ) == STATE::FAILED;
+}
+
+GLuint TextureLoader::Handle::getTexture() const
+{
+   return LoadRequest != nullptr ? LoadRequest->Texture : 0;
+}
+
+TextureLoader::TextureLoader(int worker_num, int staging_slot_num, GLsizeiptr staging_slot_size) :
+   StagingSlotNum( std::max( staging_slot_num, 1 ) ), StagingSlotSize( staging_slot_size ), StagingBuffer( 0 ),
+   MappedStagingBuffer( nullptr ), NextSlotIndex( 0 ), LoadedNum( 0 ), FailedNum( 0 ), DecodeMilliseconds( 0.0 ),
+   UploadMilliseconds( 0.0 ), StopRequested( false )
+{
+   worker_num = std::max( worker_num, 1 );
+   Workers.reserve( worker_num );
+   for (int i = 0; i < worker_num; ++i) Workers.emplace_back( &TextureLoader::decodeImages, this );
+}
+
+TextureLoader::~TextureLoader()
+{
+   {
+      std::lock_guard<std::mutex> lock( Lock );
+      StopRequested = true;
+   }
+   JobAdded.notify_all();
+   for (auto& worker : Workers) worker.join();
+
+   // The requests which were not uploaded keep their incomplete textures, which their owners delete.
+   for (const auto& request : DecodedRequests) FreeImage_Unload( request->Bitmap );
+}
+
+FIBITMAP* TextureLoader::decode(const std::string& file_path, bool is_grayscale)
+{
+   const FREE_IMAGE_FORMAT format = FreeImage_GetFileType( file_path.c_str(), 0 );
+   FIBITMAP* texture = FreeImage_Load( format, file_path.c_str() );
+   if (!texture) return nullptr;
+
+   const uint n_bits_per_pixel = FreeImage_GetBPP( texture );
+   const uint n_bits = is_grayscale ? 8 : 32;
+   if (n_bits_per_pixel == n_bits) return texture;
+
+   FIBITMAP* texture_converted = is_grayscale ?
+      FreeImage_GetChannel( texture, FICC_RED ) : FreeImage_ConvertTo32Bits( texture );
+   FreeImage_Unload( texture );
+   return texture_converted;
+}
+
+TextureLoader::Handle TextureLoader::load(const std::string& file_path, bool is_grayscale)
+{
+   GLuint texture = 0;
+   glCreateTextures( GL_TEXTURE_2D, 1, &texture );
+   auto request = std::make_shared<Request>( file_path, is_grayscale, texture );
+   {
+      std::lock_guard<std::mutex> lock( Lock );
+      Jobs.emplace_back( request );
+   }
+   JobAdded.notify_one();
+   return Handle( std::move( request ) );
+}
+
+void TextureLoader::decodeImages()
+{
+   while (true) {
+      std::shared_ptr<Request> request;
+      {
+         std::unique_lock<std::mutex> lock( Lock );
+         JobAdded.wait( lock, [this]() { return StopRequested || !Jobs.empty(); } );
+         if (StopRequested) return;
+
+         request = std::move( Jobs.front() );
+         Jobs.pop_front();
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      request->Bitmap = decode( request->FilePath, request->IsGrayscale );
+      const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      if (request->Bitmap == nullptr) {
+         std::cerr << "Could not read image file " << request->FilePath << "\n";
+         FailedNum.fetch_add( 1, std::memory_order_relaxed );
+         request->State.store( STATE::FAILED, std::memory_order_release );
+      }
+      else {
+         std::lock_guard<std::mutex> lock( Lock );
+         request->State.store( STATE::DECODED, std::memory_order_release );
+         DecodedRequests.emplace_back( request );
+         DecodeMilliseconds += elapsed.count();
+      }
+      ImageDecoded.notify_all();
+      if (DecodedCallback) DecodedCallback();
+   }
+}
+
+void TextureLoader::createStagingBuffer()
+{
+   // The coherent mapping lets the copies be seen by the uploads without any flush.
+   constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+   const GLsizeiptr size = StagingSlotSize * StagingSlotNum;
+   glCreateBuffers( 1, &StagingBuffer );
+   glNamedBufferStorage( StagingBuffer, size, nullptr, flags );
+   MappedStagingBuffer = static_cast<uchar*>(glMapNamedBufferRange( StagingBuffer, 0, size, flags ));
+   StagingSlots.assign( StagingSlotNum, StagingSlot() );
+   NextSlotIndex = 0;
+}
+
+void TextureLoader::destroyStagingBuffer()
+{
+   if (StagingBuffer == 0) return;
+
+   for (auto& slot : StagingSlots) {
+      if (slot.Fence != nullptr) glDeleteSync( slot.Fence );
+   }
+   StagingSlots.clear();
+   glUnmapNamedBuffer( StagingBuffer );
+   glDeleteBuffers( 1, &StagingBuffer );
+   StagingBuffer = 0;
+   MappedStagingBuffer = nullptr;
+}
+
+int TextureLoader::acquireStagingSlot()
+{
+   // The slots are used in turn, so the next one holds the oldest upload, which has most likely finished.
+   StagingSlot& slot = StagingSlots[NextSlotIndex];
+   if (slot.Fence != nullptr) {
+      if (glClientWaitSync( slot.Fence, 0, 0 ) == GL_TIMEOUT_EXPIRED) return -1;
+      glDeleteSync( slot.Fence );
+      slot.Fence = nullptr;
+   }
+   const int slot_index = NextSlotIndex;
+   NextSlotIndex = (NextSlotIndex + 1) % StagingSlotNum;
+   return slot_index;
+}
+
+bool TextureLoader::upload(Request& request)
+{
+   const auto width = static_cast<GLsizei>(FreeImage_GetWidth( request.Bitmap ));
+   const auto height = static_cast<GLsizei>(FreeImage_GetHeight( request.Bitmap ));
+   const auto size = static_cast<GLsizeiptr>(FreeImage_GetPitch( request.Bitmap )) * height;
+
+   // An image larger than a slot is uploaded from the client memory instead.
+   int slot_index = -1;
+   if (size <= StagingSlotSize) {
+      slot_index = acquireStagingSlot();
+      if (slot_index < 0) return false;
+   }
+
+   const auto start = std::chrono::steady_clock::now();
+   const GLsizei level_num = 1 + static_cast<GLsizei>(std::floor( std::log2( std::max( width, height ) ) ));
+   const GLenum format = request.IsGrayscale ? GL_RED : GL_BGRA;
+   glTextureStorage2D( request.Texture, level_num, request.IsGrayscale ? GL_R8 : GL_RGBA8, width, height );
+   if (slot_index >= 0) {
+      const GLsizeiptr offset = StagingSlotSize * slot_index;
+      std::copy_n( FreeImage_GetBits( request.Bitmap ), size, MappedStagingBuffer + offset );
+      glBindBuffer( GL_PIXEL_UNPACK_BUFFER, StagingBuffer );
+      glTextureSubImage2D(
+         request.Texture, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE,
+         reinterpret_cast<const GLvoid*>(offset)
+      );
+      glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+      StagingSlots[slot_index].Fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+   }
+   else {
+      glTextureSubImage2D(
+         request.Texture, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, FreeImage_GetBits( request.Bitmap )
+      );
+   }
+   glTextureParameteri( request.Texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+   glTextureParameteri( request.Texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+   glTextureParameteri( request.Texture, GL_TEXTURE_WRAP_S, GL_REPEAT );
+   glTextureParameteri( request.Texture, GL_TEXTURE_WRAP_T, GL_REPEAT );
+   glGenerateTextureMipmap( request.Texture );
+   const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+   UploadMilliseconds += elapsed.count();
+
+   FreeImage_Unload( request.Bitmap );
+   request.Bitmap = nullptr;
+   request.State.store( STATE::READY, std::memory_order_release );
+   LoadedNum++;
+   return true;
+}
+
+int TextureLoader::finalize(double budget_milliseconds)
+{
+   int finalized_num = 0;
+   const auto start = std::chrono::steady_clock::now();
+   while (true) {
+      std::shared_ptr<Request> request;
+      {
+         std::lock_guard<std::mutex> lock( Lock );
+         if (DecodedRequests.empty()) break;
+
+         request = DecodedRequests.front();
+      }
+
+      if (StagingBuffer == 0) createStagingBuffer();
+      if (!upload( *request )) break;
+
+      {
+         std::lock_guard<std::mutex> lock( Lock );
+         DecodedRequests.pop_front();
+      }
+      finalized_num++;
+
+      const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      if (elapsed.count() >= budget_milliseconds) break;
+   }
+   return finalized_num;
+}
+
+void TextureLoader::wait(const Handle& handle)
+{
+   if (!handle.isValid()) return;
+
+   while (!handle.isReady() && !handle.hasFailed()) {
+      finalize( std::numeric_limits<double>::max() );
+      if (handle.isReady()) return;
+
+      // The timeout also retries the staging slots whose fences had not signaled yet.
+      std::unique_lock<std::mutex> lock( Lock );
+      ImageDecoded.wait_for( lock, std::chrono::milliseconds( 1 ) );
+   }
+}
+
+bool TextureLoader::hasDecodedImages()
+{
+   std::lock_guard<std::mutex> lock( Lock );
+   return !DecodedRequests.empty();
+}
+
+void TextureLoader::print()
+{
+   if (LoadedNum == 0 && getFailedNum() == 0) return;
+
+   std::lock_guard<std::mutex> lock( Lock );
+   std::cout << "Textures: " << LoadedNum << " loaded, " << getFailedNum() << " failed, "
+      << DecodeMilliseconds << " ms decoding on the workers, " << UploadMilliseconds << " ms uploading\n";
+}
\ No newline at end of file